@@ -3,53 +3,921 @@
 #include <string>
 #include <ctime>
 #include <limits>
+#include <sstream>
+#include <cstdio>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <cstring>
+#include <cstdlib>
+#include <atomic>
+#include <new>
+#include <cmath>
+#include <cctype>
+#include <cerrno>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define IE_X86_SIMD 1
+#else
+#define IE_X86_SIMD 0
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <dirent.h>
+#define IE_POSIX 1
+#else
+#define IE_POSIX 0
+#endif
 
 using namespace std;
 
+// Build profiles. The case and manager stores are RecordStore templates
+// whose storage and index policies are chosen here at compile time:
+//   -DIE_KIOSK   small fixed footprint (inline arrays, lower limits)
+//   -DIE_SERVER  cases in growable heap storage, hash indexed by ID
+// IE_STORE_DYNAMIC and IE_STORE_INDEXED can also be set on their own.
+// -DIE_BENCH_ALLOC=1 replaces the global allocator with one that counts
+// calls for --bench-alloc; other builds keep the standard one.
+#ifdef IE_SERVER
+#define IE_STORE_DYNAMIC 1
+#define IE_STORE_INDEXED 1
+#endif
+#ifndef IE_STORE_DYNAMIC
+#define IE_STORE_DYNAMIC 0
+#endif
+#ifndef IE_STORE_INDEXED
+#define IE_STORE_INDEXED 0
+#endif
+#ifndef IE_BENCH_ALLOC
+#define IE_BENCH_ALLOC 0
+#endif
+
 // Constants
-const int MAX_CASES = 100;
+#ifdef IE_KIOSK
+const int MAX_CASES = 32;
+const int MAX_MANAGERS = 8;
+const int MAX_ACTIONS = 16;
+const int MAX_ASSIGNED_MANAGERS = 3;
+#else
+const int MAX_CASES = 100; // Inline case storage only; dynamic storage grows without limit
 const int MAX_MANAGERS = 20;
 const int MAX_ACTIONS = 50;
 const int MAX_ASSIGNED_MANAGERS = 5;
+#endif
+const int MAX_LOADED_BODIES = 32; // LRU bound on case bodies kept in memory
+const unsigned int INGEST_QUEUE_CAPACITY = 4096; // Records waiting for the applier; a power of two
+const int INGEST_BATCH = 256; // Records applied per journal commit
+const int MAX_INGEST_PRODUCERS = 32;
+const int MINHASH_SIZE = 64; // MinHash values in a case signature
+const int LSH_BANDS = 16; // Bands of 4 values; cases sharing any band are compared
+const double DUPLICATE_SIMILARITY = 0.75; // Share of equal values that marks a likely duplicate
+const int LSH_BUCKET_LIMIT = 16; // Cases indexed under one band value
+const int MAX_DUPLICATE_WORKERS = 8;
+const int DUPLICATE_CASES_PER_WORKER = 256; // Smaller stores are signed on fewer threads
+const char REPLICA_PREFIX[] = "/ie-replica-"; // Shared-memory name, followed by a hash of the directory
+const char REPLICA_MAGIC[8] = { 'I', 'E', 'R', 'E', 'P', 'L', 'C', '2' };
+const size_t REPLICA_MIN_CAPACITY = 1024 * 1024; // Image bytes of the first segment
+const int REPLICA_READ_ATTEMPTS = 1000; // Reader retries before giving up on a busy writer
+const int REPLICA_MAX_PATCHES = 64; // Changed ranges copied one by one; more and the whole image is copied
+const int MAX_SNAPSHOTS = 4; // Concurrent point-in-time views (reports, saves)
+const int ARCHIVE_AFTER_DAYS = 90; // Closed cases idle this long leave IE.txt
 const string DATA_FILE = "IE.txt";
+const string ARCHIVE_INDEX_FILE = "IE_archive.idx";
+const string ARCHIVE_SEGMENT_PREFIX = "IE_archive_"; // One segment per month
+const string JOURNAL_FILE = "IE.journal"; // Autosaved changes since the last full save
+const string HISTORY_FILE = "IE.history"; // Every revision of case titles, descriptions and sources
+const int HISTORY_CHECKPOINT_INTERVAL = 16; // Revisions per full copy; the rest are deltas
+const int AUTOSAVE_INTERVAL_SECONDS = 30;
+const int AUTOSAVE_RECORD_THRESHOLD = 20; // Pending records that trigger an early write
+const int SYMBOL_CHUNK_SIZE = 16384; // Interned strings per symbol table chunk
+const int MAX_SYMBOL_CHUNKS = 65536; // Chunks the table can grow to
+const int TEXT_SIZE_CLASSES = 8; // Pooled text blocks of 16, 32, ... 2048 bytes
+const size_t TEXT_CHUNK_SIZE = 256 * 1024; // Arena chunk that text blocks are carved from
+const size_t LOAD_BLOCK_SIZE = 1024 * 1024; // DATA_FILE is read and scanned this much at a time
+const int MAX_QUERY_TERMS = 16;
+const int MAX_QUERY_VALUES = MAX_MANAGERS; // Alternatives per term, or managers in a department
+const int LOAD_WEIGHT_NEW = 1; // Open or Assigned case, towards a manager's load
+const int LOAD_WEIGHT_WORKED = 2; // In Progress or Exported case
+const string CHANGE_LOG_FILE = "IE.changes"; // Every change event, one JSON object per line
+const unsigned int CHANGE_RING_CAPACITY = 1024; // Events queued for the feed writer; a power of two
+const size_t CHANGE_SINK_BUFFER = 64 * 1024; // Bytes held back for a slow live consumer
+const int MAX_TOMBSTONES = 1000; // Deletions remembered for delta exports
+const int MODIFICATION_INDEX_CAPACITY = 4 * MAX_CASES; // Inline capacity; compacted when full
+const int SLA_SUB_BUCKETS = 8; // Histogram buckets per doubling of duration
+const int SLA_BUCKETS = 30 * SLA_SUB_BUCKETS; // Durations up to 2^32 seconds
+const int MAX_SLA_WORKERS = 8;
+const int MAX_SAVE_WORKERS = 8;
+const int SAVE_CASES_PER_WORKER = 256; // Smaller saves use fewer threads
+const int MAX_SLA_SOURCES = 100;
+const int MAX_SLA_GROUPS = 1 + 2 * MAX_MANAGERS + MAX_SLA_SOURCES; // All, managers, departments, sources
+const size_t REPORT_BUFFER_SIZE = 256 * 1024; // Report output is written in blocks of this size
+const string DEFAULT_REPORT_FIELDS = "id,title,status,created,managers,actions";
+const int LATENCY_SIZES = 4; // Dataset sizes per latency run, each double the last
+const int LATENCY_ROUNDS = 3; // Sessions per size; the fastest is kept
+const int LATENCY_TIMEOUT_MS = 30000; // Longest wait for a prompt before a step fails
+const double LATENCY_SUPERLINEAR = 1.5; // Growth exponent above which a command is flagged
+const double LATENCY_NOISE_MS = 1.0; // Commands faster than this at the largest size are not flagged
 
 // Data Structures
+// Handle into the interned string pool, for short fields that draw from a
+// small vocabulary (source, status, department, manager names). 0 is "".
+struct Symbol {
+    unsigned int id = 0;
+    Symbol() {}
+    Symbol(const string& text);
+    Symbol(const char* text);
+    const string& str() const;
+    bool empty() const { return id == 0; }
+};
+
+// YYYY-MM-DD packed as the integer YYYYMMDD; 0 means no date
+struct PackedDate {
+    unsigned int value = 0;
+    PackedDate() {}
+    PackedDate(const string& text);
+    PackedDate(const char* text) : PackedDate(string(text)) {}
+    size_t format(char* buffer) const; // Writes up to 10 bytes, returns the length
+    string str() const;
+    bool empty() const { return value == 0; }
+};
+
+// HH:MM:SS packed as seconds since midnight; -1 means no time
+struct PackedTime {
+    int value = -1;
+    PackedTime() {}
+    PackedTime(const string& text);
+    PackedTime(const char* text) : PackedTime(string(text)) {}
+    size_t format(char* buffer) const; // Writes up to 8 bytes, returns the length
+    string str() const;
+    bool empty() const { return value < 0; }
+};
+
+// Title and description text. The bytes live in a block from the text pool
+// (see allocateText) instead of a heap allocation per field; copies are deep
+// and the block goes back to the pool when the field is reassigned or dies.
+struct Text {
+    char* chars = nullptr;
+    unsigned int size = 0;
+    Text() {}
+    Text(const string& text) { assign(text.data(), text.length()); }
+    Text(const char* text) { assign(text, strlen(text)); }
+    Text(const Text& other) { assign(other.chars, other.size); }
+    Text(Text&& other) noexcept { swap(other); }
+    Text& operator=(const Text& other);
+    Text& operator=(Text&& other) noexcept { swap(other); return *this; }
+    ~Text();
+    void assign(const char* text, size_t length);
+    void swap(Text& other) noexcept;
+    size_t length() const { return size; }
+    bool empty() const { return size == 0; }
+    string str() const { return string(chars ? chars : "", size); }
+};
+
 struct Action {
-    string description;
-    string date;
-    string time;
-    string manager;
+    Text description;
+    PackedDate date;
+    PackedTime time;
+    Symbol manager;
 };
 
 struct Manager {
     string name;
-    string department;
+    Symbol department;
     string password;
     bool active = true;
+    bool dirty = false; // Changed since last handed to autosave
+    long long modifiedSeq = 0; // Change sequence of the last modification
+    PackedDate modifiedDate;
+    PackedTime modifiedTime;
 };
 
 struct Case {
     int id;
-    string title;
-    string description;
-    string creationDate;
-    string creationTime;
-    string source;
-    string status = "Open";
-    string assignedManagers[MAX_ASSIGNED_MANAGERS];
+    Text title;
+    Text description;
+    PackedDate creationDate;
+    PackedTime creationTime;
+    Symbol source;
+    Symbol status = "Open";
+    PackedDate lastActionDate; // Kept with the summary for archiving decisions
+    Symbol assignedManagers[MAX_ASSIGNED_MANAGERS];
     int assignedManagerCount = 0;
+    long long modifiedSeq = 0; // Change sequence of the last modification
+    PackedDate modifiedDate;
+    PackedTime modifiedTime;
     Action actions[MAX_ACTIONS];
     int actionCount = 0;
+
+    // Lazy loading: description and actions live on disk until needed
+    bool bodyLoaded = true;
+    bool bodyModified = false;
+    streamoff recordOffset = -1; // Offset of "Case ID:" line in DATA_FILE
+    streamoff journalOffset = -1; // Full record in JOURNAL_FILE of a modified body, or -1
+    long long journaledSeq = 0; // modifiedSeq as of which that record holds the body
+    bool dirty = false; // Changed since last handed to autosave
+    int version = 0; // storeVersion when last written, for snapshots
+};
+
+// A deleted case (caseId >= 0) or manager, kept for delta exports
+struct Tombstone {
+    int caseId = -1;
+    bool archived = false; // The case moved to the archive rather than being deleted
+    string managerName;
+    long long seq = 0;
+    PackedDate date;
+    PackedTime time;
+};
+
+// (sequence, case) pair in modificationIndex
+struct ModificationEntry {
+    long long seq;
+    int caseId;
+};
+
+// Report output: layout and per-case projection
+enum ReportFormat { REPORT_TEXT, REPORT_JSON, REPORT_CSV };
+enum ReportField { REPORT_ID, REPORT_TITLE, REPORT_DESCRIPTION, REPORT_STATUS, REPORT_SOURCE,
+                   REPORT_CREATED, REPORT_MANAGERS, REPORT_ACTIONS, REPORT_LAST_ACTION,
+                   REPORT_MODIFIED, REPORT_ACTION_LOG, REPORT_FIELD_COUNT };
+const char* const REPORT_FIELD_NAMES[REPORT_FIELD_COUNT] = {
+    "id", "title", "description", "status", "source", "created", "managers",
+    "actions", "last_action", "modified", "action_log"
+};
+
+struct ReportOptions {
+    ReportFormat format = REPORT_TEXT;
+    ReportField fields[REPORT_FIELD_COUNT] = { REPORT_ID, REPORT_TITLE, REPORT_STATUS, REPORT_CREATED,
+                                               REPORT_MANAGERS, REPORT_ACTIONS };
+    int fieldCount = 6;
+    bool needsBody = false; // Description or action log requested
+    bool includeArchive = false;
+    string target; // File name, "-" for stdout, empty for a new dated file
+};
+
+// SLA metrics and the groups they are broken down by
+enum SlaMetric { SLA_FIRST_ACTION, SLA_TO_CLOSE, SLA_AGE_OPEN, SLA_AGE_ASSIGNED,
+                 SLA_AGE_IN_PROGRESS, SLA_AGE_EXPORTED, SLA_METRICS };
+enum SlaDimension { SLA_ALL, SLA_MANAGER, SLA_DEPARTMENT, SLA_SOURCE };
+
+// Durations in seconds, bucketed on a log scale (see durationBucket)
+struct DurationHistogram {
+    unsigned int counts[SLA_BUCKETS];
+    long long total;
+    long long sum;
+    long long maxValue;
+};
+
+struct SlaGroup {
+    SlaDimension dimension;
+    Symbol key; // Manager, department or source; empty for SLA_ALL
+    DurationHistogram metrics[SLA_METRICS];
+};
+
+// One worker's partial results
+struct SlaTable {
+    SlaGroup groups[MAX_SLA_GROUPS];
+    int groupCount;
+    long long casesSeen;
+    long long unreadable;
+    long long droppedGroups;
+};
+
+// Storage policies for RecordStore and the per-case lists that grow with
+// it. InlineStorage<N> holds up to N elements inside the object itself;
+// HeapStorage grows a heap array by doubling and is never full. append()
+// hands back a slot that may hold a stale element for the caller to
+// overwrite.
+template <int Capacity>
+struct InlineStorage {
+    template <class T>
+    struct List {
+        T items[Capacity];
+        int count = 0;
+        int size() const { return count; }
+        bool full() const { return count == Capacity; }
+        T& operator[](int i) { return items[i]; }
+        const T& operator[](int i) const { return items[i]; }
+        T& append() { return items[count++]; } // Caller checks full()
+        void truncate(int n) { count = n; }
+        void clear() { count = 0; }
+        size_t bytes() const { return sizeof(*this); }
+    };
+};
+
+struct HeapStorage {
+    template <class T>
+    struct List {
+        T* items = nullptr;
+        int count = 0;
+        int allocated = 0;
+        List() {}
+        List(const List& other) { *this = other; }
+        List& operator=(const List& other) {
+            if (this == &other) return *this;
+            reserve(other.count);
+            for (int i = 0; i < other.count; i++) items[i] = other.items[i];
+            count = other.count;
+            return *this;
+        }
+        ~List() { delete[] items; }
+        int size() const { return count; }
+        bool full() const { return false; }
+        T& operator[](int i) { return items[i]; }
+        const T& operator[](int i) const { return items[i]; }
+        T& append() {
+            if (count == allocated) reserve(allocated == 0 ? 16 : allocated * 2);
+            return items[count++];
+        }
+        void reserve(int n) {
+            if (n <= allocated) return;
+            T* grown = new T[n];
+            for (int i = 0; i < count; i++) grown[i] = move(items[i]);
+            delete[] items;
+            items = grown;
+            allocated = n;
+        }
+        void truncate(int n) { count = n; }
+        void clear() { count = 0; }
+        size_t bytes() const { return sizeof(*this) + allocated * sizeof(T); }
+    };
+};
+
+// Index policies: how RecordStore finds a record by its key (case ID or
+// manager name). ScanIndex keeps nothing and compares keys in order;
+// HashIndex keeps an open-addressing table of positions, rebuilt when
+// records move.
+inline int recordKey(const Case& c) { return c.id; }
+inline const string& recordKey(const Manager& m) { return m.name; }
+inline size_t hashKey(int key) { return (unsigned int)key * 2654435761u; }
+inline size_t hashKey(const string& key) {
+    size_t hash = 2166136261u;
+    for (size_t i = 0; i < key.length(); i++) hash = (hash ^ (unsigned char)key[i]) * 16777619u;
+    return hash;
+}
+
+template <class Key>
+struct ScanIndex {
+    template <class List>
+    int find(const List& records, const Key& key) const {
+        for (int i = 0; i < records.size(); i++) {
+            if (recordKey(records[i]) == key) return i;
+        }
+        return -1;
+    }
+    template <class List> void added(const List&, int) {}
+    template <class List> void rebuild(const List&) {}
+    size_t bytes() const { return sizeof(*this); }
+};
+
+template <class Key>
+struct HashIndex {
+    int* slots = nullptr; // Position + 1; 0 is free
+    int tableSize = 0; // A power of two, at least twice the record count
+    HashIndex() {}
+    HashIndex(const HashIndex&) = delete;
+    HashIndex& operator=(const HashIndex&) = delete;
+    ~HashIndex() { delete[] slots; }
+
+    template <class List>
+    int find(const List& records, const Key& key) const {
+        if (tableSize == 0) return -1;
+        for (size_t h = hashKey(key) & (tableSize - 1); slots[h] != 0; h = (h + 1) & (tableSize - 1)) {
+            if (recordKey(records[slots[h] - 1]) == key) return slots[h] - 1;
+        }
+        return -1;
+    }
+    template <class List>
+    void added(const List& records, int position) {
+        if (2 * records.size() > tableSize) {
+            rebuild(records);
+            return;
+        }
+        insert(records, position);
+    }
+    template <class List>
+    void rebuild(const List& records) {
+        if (2 * records.size() > tableSize) {
+            int size = 16;
+            while (size < 2 * records.size()) size *= 2;
+            delete[] slots;
+            slots = new int[size];
+            tableSize = size;
+        }
+        for (int i = 0; i < tableSize; i++) slots[i] = 0;
+        for (int i = 0; i < records.size(); i++) insert(records, i);
+    }
+    template <class List>
+    void insert(const List& records, int position) {
+        size_t h = hashKey(recordKey(records[position])) & (tableSize - 1);
+        while (slots[h] != 0) h = (h + 1) & (tableSize - 1);
+        slots[h] = position + 1;
+    }
+    size_t bytes() const { return sizeof(*this) + tableSize * sizeof(int); }
+};
+
+// Ordered records with lookup by key. Keys must not be changed through
+// operator[]; records keep their relative order on erase.
+template <class Record, class Storage, class Index>
+struct RecordStore {
+    typename Storage::template List<Record> records;
+    Index index;
+
+    int size() const { return records.size(); }
+    bool full() const { return records.full(); }
+    Record& operator[](int i) { return records[i]; }
+    const Record& operator[](int i) const { return records[i]; }
+    template <class Key>
+    int find(const Key& key) const { return index.find(records, key); }
+
+    // Copies record in at the end; the caller checks full()
+    Record& append(const Record& record) {
+        records.append() = record;
+        index.added(records, records.size() - 1);
+        return records[records.size() - 1];
+    }
+    void erase(int position) {
+        for (int i = position; i < records.size() - 1; i++) records[i] = move(records[i + 1]);
+        records.truncate(records.size() - 1);
+        index.rebuild(records);
+    }
+    // Keeps the first n records, after the caller has compacted in place
+    void truncate(int n) {
+        records.truncate(n);
+        index.rebuild(records);
+    }
+    size_t bytes() const { return records.bytes() + index.bytes(); }
+};
+
+#if IE_STORE_DYNAMIC
+typedef HeapStorage CaseStorage;
+typedef HeapStorage ModificationStorage;
+#else
+typedef InlineStorage<MAX_CASES> CaseStorage;
+typedef InlineStorage<MODIFICATION_INDEX_CAPACITY> ModificationStorage;
+#endif
+#if IE_STORE_INDEXED
+typedef HashIndex<int> CaseIndex;
+typedef HashIndex<string> ManagerIndex;
+#else
+typedef ScanIndex<int> CaseIndex;
+typedef ScanIndex<string> ManagerIndex;
+#endif
+// The scheduler and snapshots index managers by position in fixed arrays,
+// so manager storage stays inline in every profile
+typedef InlineStorage<MAX_MANAGERS> ManagerStorage;
+typedef RecordStore<Case, CaseStorage, CaseIndex> CaseStore;
+typedef RecordStore<Manager, ManagerStorage, ManagerIndex> ManagerStore;
+
+// A list with one entry per case at most, stored like the cases
+template <class T>
+using CaseList = typename CaseStorage::template List<T>;
+
+// MinHash signature of an open case's title and description words
+struct CaseSignature {
+    int caseId = 0;
+    unsigned int minHash[MINHASH_SIZE];
+};
+inline int recordKey(const CaseSignature& s) { return s.caseId; }
+typedef RecordStore<CaseSignature, CaseStorage, CaseIndex> SignatureStore;
+
+// One LSH band of a signature, hashed; caseId -1 marks an empty slot
+struct BandEntry {
+    unsigned int key;
+    int caseId;
+};
+
+// A case that looks like a copy of an older open case
+struct DuplicateMatch {
+    int caseId = -1;
+    int duplicateOf = -1;
+    double similarity = 0; // Estimated Jaccard similarity of their word sets
+};
+
+// Sub-list currently being read inside a case record
+enum CaseListMode { LIST_NONE, LIST_MANAGERS, LIST_ACTIONS };
+
+// Point-in-time view of the case store. Taking one is O(1): cases are only
+// copied (into preimages) when the interactive thread first modifies or
+// deletes them afterwards. Managers are few and copied up front.
+struct CaseSnapshot {
+    bool active = false;
+    int epoch = 0;
+    CaseList<Case*> preimages;
+    Manager managers[MAX_MANAGERS];
+    int managerCount = 0;
+    int nextCaseId = 0;
+    int caseCount = 0;
+};
+
+// Changes handed from the interactive thread to the autosave writer: the
+// IDs of changed cases are serialized later from the snapshot
+struct AutosaveBatch {
+    CaseSnapshot* snap;
+    CaseList<int> caseIds;
+    string records; // Manager changes and deletions, already serialized
+    int recordCount;
+    int nextCaseId;
+    long long changeSequence; // Every event up to here describes a change in this batch or an earlier one
+};
+
+// A modified body the autosave writer has put in the journal: the case as
+// of modifiedSeq has its full record at offset
+struct JournaledBody {
+    int caseId;
+    long long modifiedSeq;
+    streamoff offset;
+};
+
+// One implementation of the byte and delimiter search used by the loaders
+struct TextScanner {
+    const char* name;
+    const char* (*findByte)(const char* p, const char* end, char c);
+    const char* (*findToken)(const char* p, const char* end, const char* token, size_t length);
+};
+
+// One line of ARCHIVE_INDEX_FILE, pointing at a record in a segment
+struct ArchiveEntry {
+    int id;
+    string creationDate;
+    string closedDate;
+    string segment;
+    streamoff offset;
+    string title;
+};
+
+// Where an archived case's record is, from its ARCHIVE_INDEX_FILE line
+struct ArchiveLocation {
+    int id;
+    Symbol segment;
+    streamoff offset;
+};
+
+// Field a query term tests
+enum QueryField { QUERY_STATUS, QUERY_SOURCE, QUERY_MANAGER, QUERY_DEPARTMENT,
+                  QUERY_CREATED, QUERY_ACTIONS, QUERY_IDLE, QUERY_ID };
+enum QueryOp { QUERY_EQ, QUERY_NE, QUERY_LT, QUERY_LE, QUERY_GT, QUERY_GE };
+
+// One "field op value" term of a case query. Symbol fields match any of
+// values; a department term holds the names of that department's managers.
+struct QueryTerm {
+    QueryField field;
+    QueryOp op;
+    Symbol values[MAX_QUERY_VALUES];
+    int valueCount = 0;
+    long long number = 0; // Dates as YYYYMMDD, counts, days or IDs
+};
+
+// Terms that must all hold
+struct CaseQuery {
+    QueryTerm terms[MAX_QUERY_TERMS];
+    int termCount = 0;
+};
+
+// Min-heap of manager indices ordered by load, with each manager's slot so
+// a changed load is one sift. Heap 0 holds every active manager, the others
+// one department each.
+struct LoadHeap {
+    Symbol department;
+    int items[MAX_MANAGERS];
+    int position[MAX_MANAGERS]; // -1 when the manager is not in this heap
+    int count = 0;
+};
+
+// Read-only, seekable stream over bytes owned elsewhere
+struct MemoryBuffer : streambuf {
+    MemoryBuffer(const char* data, size_t size) {
+        char* start = const_cast<char*>(data);
+        setg(start, start, start + size);
+    }
+    pos_type seekoff(off_type offset, ios_base::seekdir from, ios_base::openmode) override {
+        char* base = from == ios_base::beg ? eback() : from == ios_base::cur ? gptr() : egptr();
+        if (offset < eback() - base || offset > egptr() - base) return pos_type(off_type(-1));
+        setg(eback(), base + offset, egptr());
+        return pos_type(gptr() - eback());
+    }
+    pos_type seekpos(pos_type position, ios_base::openmode which) override {
+        return seekoff(off_type(position), ios_base::beg, which);
+    }
+};
+
+// One save worker's share of the case store: records [begin, end) as text
+struct SaveChunk {
+    int begin = 0;
+    int end = 0;
+    string text;
+    int failedCaseId = -1; // Case whose body could not be read back, if any
+};
+
+// One line of a scripted latency session: the input sent ("#" stands for a
+// case ID in the middle of the dataset), the prompt that ends the step (null
+// waits for the app to exit) and text that must also appear, before or after
+// the prompt, so a background report's completion message can be awaited.
+// Steps with a label are timed and reported.
+struct LatencyStep {
+    const char* input;
+    const char* until;
+    const char* expect;
+    const char* label;
+};
+
+// One mutation handed to the ingest applier. Cases are opened with a title,
+// description (text) and source; actions are logged on caseId by author.
+enum IngestKind { INGEST_CASE, INGEST_ACTION };
+
+struct IngestRecord {
+    IngestKind kind = INGEST_ACTION;
+    int caseId = 0;
+    string author;
+    string title;
+    string text;
+    string source;
+};
+
+// Slot of the ingest queue. sequence == position when free for the
+// producer that claims position, position + 1 once filled, and
+// position + INGEST_QUEUE_CAPACITY when the applier has emptied it.
+struct IngestCell {
+    atomic<unsigned int> sequence;
+    IngestRecord record;
+};
+
+// What the applier did with the queued records, and how full it found the
+// queue at each batch
+struct IngestStats {
+    long long casesAdded = 0;
+    long long duplicates = 0; // New cases flagged as likely duplicates
+    long long actionsAdded = 0;
+    long long rejected = 0;
+    long long batches = 0;
+    long long depthTotal = 0;
+    unsigned int maxDepth = 0;
+};
+
+
+// Shared-memory replica (POSIX). The segment starts with a ReplicaHeader;
+// the image after it holds a table of caseCount ReplicaCases at caseTable,
+// one of managerCount ReplicaManagers at managerTable, and the strings and
+// lists they point to. Offsets are from the start of the image; strings
+// are a 4-byte length and the bytes.
+struct ReplicaState {
+    unsigned int retired; // Set when the writer has moved to a larger segment
+    unsigned long long capacity; // Image bytes the segment can hold
+    unsigned long long imageSize;
+    unsigned long long dataFileSize; // DATA_FILE that record offsets point into
+    long long changeSequence; // Last change included
+    int caseCount;
+    int managerCount;
+    int nextCaseId;
+    int writerPid;
+    unsigned long long caseTable;
+    unsigned long long managerTable;
+};
+
+struct ReplicaHeader {
+    char magic[8];
+    atomic<unsigned int> sequence; // Odd while the writer is replacing the image
+    ReplicaState state;
+};
+
+struct ReplicaCase {
+    int id;
+    unsigned int creationDate;
+    int creationTime;
+    unsigned int lastActionDate;
+    long long modifiedSeq;
+    unsigned int modifiedDate;
+    int modifiedTime;
+    long long recordOffset; // Record in DATA_FILE with the body, or -1 when it is in the image
+    unsigned int title;
+    unsigned int description; // 0 when the body is in DATA_FILE
+    unsigned int status;
+    unsigned int source;
+    int assignedManagerCount;
+    unsigned int assignedManagers; // String offsets
+    int actionCount;
+    unsigned int actions; // ReplicaActions; 0 when the body is in DATA_FILE
+};
+
+struct ReplicaAction {
+    unsigned int date;
+    int time;
+    unsigned int manager;
+    unsigned int description;
+};
+
+struct ReplicaManager {
+    unsigned int name;
+    unsigned int department;
+    int active;
+};
+
+// Bytes of the private image that differ from the segment
+struct ReplicaPatch {
+    size_t offset;
+    size_t length;
+};
+
+// Edit history (HISTORY_FILE): one line per revision of a case's title,
+// description and source, appended as edits happen. Revision 0 is the case
+// as created. A checkpoint line holds all three fields; a delta line holds
+// only what changed since the revision before. Every
+// HISTORY_CHECKPOINT_INTERVAL-th revision is a checkpoint, so any revision
+// is rebuilt from at most that many lines.
+enum HistoryField { HISTORY_TITLE, HISTORY_DESCRIPTION, HISTORY_SOURCE, HISTORY_FIELDS };
+
+// One field of a revision. In a delta the new value keeps prefix bytes from
+// the front of the old one and suffix bytes from its end, with text in
+// between; prefix -1 means unchanged. A checkpoint keeps nothing.
+struct FieldChange {
+    int prefix = 0;
+    int suffix = 0;
+    string text;
+};
+
+struct Revision {
+    int caseId = 0;
+    int number = 0;
+    long long seq = 0; // Change sequence of the edit; 0 for revision 0
+    PackedDate date;
+    PackedTime time;
+    bool checkpoint = false;
+    string author; // Empty for revision 0
+    FieldChange fields[HISTORY_FIELDS];
+};
+
+// Index entry for one revision line. A case's revisions are chained from
+// newest to oldest through previous.
+struct HistoryEntry {
+    int caseId;
+    int number;
+    PackedDate date;
+    PackedTime time;
+    bool checkpoint;
+    streamoff offset; // Line in HISTORY_FILE
+    int previous; // historyEntries index of revision number - 1, or -1
+};
+
+// Newest revision of each case that has a history. Deleted and archived
+// cases keep theirs, so this is heap-grown in every profile.
+struct HistoryHead {
+    int caseId;
+    int latest; // historyEntries index
 };
+inline int recordKey(const HistoryHead& h) { return h.caseId; }
+typedef RecordStore<HistoryHead, HeapStorage, CaseIndex> HistoryStore;
 
 // Global Variables
-Case cases[MAX_CASES];
-Manager managers[MAX_MANAGERS];
-int caseCount = 0;
-int managerCount = 0;
+// Interned string pool; defined before the store so that default-constructed
+// cases can intern their initial status. Entries never move once added, so
+// Symbol::str() needs no lock; lookups and inserts take symbolMutex because
+// cases are also constructed on the report and autosave threads. The table
+// grows a chunk at a time, so entries keep their address as it grows.
+mutex symbolMutex;
+string symbolFirstChunk[SYMBOL_CHUNK_SIZE] = { "" };
+string* symbolChunks[MAX_SYMBOL_CHUNKS] = { symbolFirstChunk };
+unsigned int symbolCount = 1;
+unsigned int* symbolSlots = nullptr; // Open addressing over the table, 0 = free
+unsigned int symbolSlotCount = 0; // A power of two, at least twice symbolCount
+
+// Dates and times in DATA_FILE that are not YYYY-MM-DD / HH:MM:SS. They
+// cannot be packed, so loadData refuses the file instead of blanking them.
+atomic<int> unpackableFields(0);
+string firstUnpackableField; // Written by whoever counts the first one
+
+// Text pool: blocks are carved from TEXT_CHUNK_SIZE arena chunks and
+// recycled through per-size-class free lists. Chunks are only given back
+// in bulk by releaseTextArena. Any thread may allocate, so it has a lock.
+mutex textPoolMutex;
+char* textChunk = nullptr; // Newest chunk; its first bytes link to the previous one
+size_t textChunkUsed = 0;
+char* textFreeLists[TEXT_SIZE_CLASSES];
+long long textChunkCount = 0;
+atomic<long long> heapAllocationCount(0); // Counted by operator new in IE_BENCH_ALLOC builds
+
+CaseStore cases;
+ManagerStore managers;
 string currentUser;
 bool currentUserIsManager = false;
 int nextCaseId = 1000;
+int residentBodies[MAX_LOADED_BODIES]; // Loaded bodies also in DATA_FILE, least recently used first
+int residentBodyCount = 0;
+
+// ARCHIVE_INDEX_FILE by case ID, caught up with lines appended since it was
+// last read; only the interactive thread uses it. Archived cases stay
+// archived, so this is heap-grown in every profile.
+HeapStorage::List<ArchiveLocation> archiveLocations; // Ascending ID; for a repeated ID the earliest line first
+streamoff archiveIndexRead = 0; // Bytes of ARCHIVE_INDEX_FILE in archiveLocations
+bool creationDatesOrdered = false; // cases[] is also in creation date order
+
+// Assignment load, indexed like managers[]; only the interactive thread uses it
+int managerLoad[MAX_MANAGERS];
+int managerDepartmentHeap[MAX_MANAGERS]; // Index into loadHeaps, -1 if inactive
+LoadHeap loadHeaps[MAX_MANAGERS + 1];
+int loadHeapCount = 0;
+short* managerOfSymbol = nullptr; // managers[] index for an interned name, or -1
+unsigned int managerOfSymbolSize = 0; // Symbols covered; later ones name no manager
+
+// Change feed; changeRing is a single-producer (interactive thread),
+// single-consumer (feed thread) ring indexed by free-running counters
+string changeRing[CHANGE_RING_CAPACITY];
+atomic<unsigned int> changeRingHead(0);
+atomic<unsigned int> changeRingTail(0);
+long long changeSequence = 0;
+string changeSpill; // Event lines that found the ring full, under changeFeedMutex
+atomic<bool> changeSpilling(false); // changeSpill is non-empty; later events queue behind it
+long long totalSpilled = 0;
+long long totalSinkDropped = 0;
+long long totalUnlogged = 0; // Events left out of the log because their changes were never saved
+string changeSinkTarget; // Live consumer: a file or FIFO path, or unix:<socket path>
+atomic<long long> durableChangeSequence(0); // Events up to here describe changes in DATA_FILE or the journal
+long long loggedChangeSequence = -1; // Last sequence CHANGE_LOG_FILE accounted for at load; -1 without a log
+long long loadedChangeSequence = 0; // Highest stamp in the loaded data
+atomic<bool> changeFeedStopping(false);
+mutex changeFeedMutex;
+condition_variable changeFeedWakeup;
+thread changeFeedThread;
+
+// Delta exports
+ModificationStorage::List<ModificationEntry> modificationIndex; // Ascending seq
+Tombstone tombstones[MAX_TOMBSTONES]; // Ascending seq
+int tombstoneCount = 0;
+long long tombstoneHorizon = 0; // Deletions up to this sequence may be missing
+long long journaledTombstoneSeq = 0;
+
+// Snapshot state; storeMutex guards cases[] and cases.size() against
+// concurrent snapshot readers (only the interactive thread writes)
+mutex storeMutex;
+int storeVersion = 0;
+CaseSnapshot snapshots[MAX_SNAPSHOTS];
+thread reportThread;
+
+// Autosave state; autosaveQueue is the handoff from the interactive thread
+// and pendingJournal holds serialized batches not yet written
+CaseList<int> deletedCaseIds;
+string deletedManagerNames[MAX_MANAGERS];
+int deletedManagerCount = 0;
+AutosaveBatch autosaveQueue[MAX_SNAPSHOTS];
+int autosaveQueueCount = 0;
+string pendingJournal;
+long long pendingJournalSeq = 0; // changeSequence of the last batch in pendingJournal
+HeapStorage::List<JournaledBody> pendingBodies; // Modified bodies in pendingJournal, offsets within it
+HeapStorage::List<JournaledBody> journaledBodies; // Durable in JOURNAL_FILE, not yet noted on cases[]
+int pendingRecords = 0;
+bool autosaveStopping = false;
+mutex autosaveMutex;
+mutex journalFileMutex; // Held while the journal is written or truncated
+condition_variable autosaveWakeup;
+thread autosaveThread;
+
+unsigned long long loadedDataSize = 0, loadedDataHash = 0; // DATA_FILE as loaded, for the replica stamp
+
+// Ingest queue: bounded, many producers, one applier. Producers claim a
+// position by advancing ingestTail; the applier alone advances ingestHead.
+IngestCell ingestQueue[INGEST_QUEUE_CAPACITY];
+atomic<unsigned int> ingestTail(0);
+atomic<unsigned int> ingestHead(0);
+atomic<long long> ingestFullRetries(0); // Enqueues retried because the queue was full
+atomic<long long> ingestMalformed(0); // Input lines producers could not parse
+mutex ingestLock; // Guards the queue only in the locked --bench-ingest baseline
+
+// Near-duplicate index over open cases; bandTable holds each signature's
+// LSH bands by open addressing. Changed only by the thread that owns the store.
+SignatureStore caseSignatures;
+BandEntry* bandTable = nullptr;
+int bandTableSize = 0;
+int bandEntryCount = 0;
+
+// Shared-memory replica this process publishes, if any; only the
+// interactive thread uses it
+ReplicaHeader* replicaHeader = nullptr;
+size_t replicaSegmentSize = 0;
+unsigned long long replicaInode = 0; // Identifies our segment among later ones under the same name
+long long replicaPublishedSeq = -1; // changeSequence of the last publish
+string replicaImage; // What the segment holds; patched between rebuilds
+ReplicaState replicaImageState; // Tables and counts of replicaImage
+int replicaCaseCapacity = 0; // Entries the tables have room for before moving
+int replicaManagerCapacity = 0;
+size_t replicaRebuiltSize = 0; // Image size after the last rebuild
+unsigned long long replicaDataHash = 0; // loadedDataHash the record offsets were taken from
+
+// Edit history index, rebuilt from HISTORY_FILE at startup; only the
+// interactive thread appends revisions
+HeapStorage::List<HistoryEntry> historyEntries;
+HistoryStore historyHeads;
+streamoff historyFileSize = 0; // Where the next revision goes; -1 if the file is unusable
 
 // Functions
 // User flow
@@ -64,15 +932,28 @@ void reportMenu();
 
 // Case operations
 void addCase();
+int createCase(const string& title, const string& description, const string& source, DuplicateMatch& match);
 void viewCases(bool brief = false);
 bool viewCaseDetails(int caseId);
+void printCaseDetails(const Case& c);
+void printCaseDetails(const Case& c, const Case& body);
 void assignManagerToCase();
 void addActionToCase();
+void recordCaseAction(Case& c, const string& description, const string& manager);
 void exportCase();
 void closeCase();
 void editCase();
 void deleteCase();
 
+// Automatic assignment
+int caseLoadWeight(const Case& c);
+void rebuildLoadHeaps();
+void adjustCaseLoad(const Case& c, int sign);
+int pickLeastLoadedManager(const Case& c, const string& department);
+string chooseManagerAutomatically(const Case& c);
+void listManagersWithLoad(const Case& c);
+void assignOpenCases();
+
 // Manager operations
 void addManager();
 void viewManagers();
@@ -81,16 +962,216 @@ void toggleManagerStatus();
 void deleteManager();
 
 // Reporting
-void generateReport();
+void generateReport(const ReportOptions& options);
+void customReport();
+bool parseReportOptions(const string& format, const string& fields, ReportOptions& options, string& error);
+bool runReport(CaseSnapshot* snap, ReportOptions options);
+void writeReportEntry(string& out, const Case& c, const Case& body, const ReportOptions& options);
+int runBatchReport(const string& format, const string& fields, const string& target, bool includeArchive);
+void generateSlaReport();
+void runSlaReport(CaseSnapshot* snap);
+
+// Archive of old closed cases
+int archiveClosedCases(int minAgeDays);
+bool parseArchiveEntry(const string& line, ArchiveEntry& entry);
+void loadArchiveIndex();
+int findArchiveLocation(int caseId);
+bool findArchivedCase(int caseId, Case& out);
+void searchArchive();
+
+// Case queries
+bool parseQuery(const string& text, CaseQuery& query, string& error);
+bool caseMatchesQuery(const Case& c, const CaseQuery& query, int today);
+int runQuery(const CaseQuery& query, ostream& out, int& scanned);
+void writeQueryMatch(ostream& out, const Case& c);
+int findFirstCaseCreatedAfter(long long date);
+void updateCreationOrder();
+void queryCases();
+int runBatchQuery(const string& text);
 
 // File I/O
 void saveData();
 void loadData();
+void parseCaseLine(Case& c, const string& line, CaseListMode& listMode, bool withBody);
+void loadDateField(PackedDate& date, const string& text);
+void loadTimeField(PackedTime& time, const string& text);
+bool readCaseRecord(istream& in, streamoff offset, Case& out);
+bool readStoredCase(const Case& c, ifstream& dataFile, ifstream& journal, Case& out);
+bool loadCaseBody(Case& c);
+void touchResidentBody(int caseId);
+void dropResidentBody(int k);
+void makeRoomForBody();
+void noteJournaledBodies();
+void evictCaseBody(Case& c);
+void writeCaseRecord(ostream& out, const Case& c, const Case& body);
+void writeManagerRecord(ostream& out, const Manager& m);
+void serializeCaseRange(SaveChunk* chunk, CaseList<streamoff>* offsets);
+bool writeFileDurably(const string& path, const string* const parts[], int partCount);
+bool appendFileDurably(const string& path, const string& text, streamoff& start);
+void syncDirectory();
+unsigned long long hashBytes(const char* data, size_t length, unsigned long long hash = 14695981039346656037ULL);
+
+// Copy-on-write snapshots
+CaseSnapshot* takeSnapshot();
+void releaseSnapshot(CaseSnapshot* snap);
+bool snapshotNextCase(CaseSnapshot* snap, int afterId, Case& out);
+void prepareCaseWrite(Case& c);
+int findFirstCaseAfter(int caseId);
+
+// Autosave
+void startAutosave();
+void stopAutosave();
+void autosaveLoop();
+void autosaveCommit();
+void writeJournalCase(ostream& out, const Case& c);
+void markCaseDeleted(int caseId);
+void markManagerDeleted(const string& managerName);
+void replayJournal();
+void applyJournalBatch(const string& batch);
+
+// Ingestion
+void resetIngestQueue();
+bool tryEnqueueIngest(IngestRecord& record);
+bool tryDequeueIngest(IngestRecord& record);
+bool lockedEnqueueIngest(IngestRecord& record);
+bool lockedDequeueIngest(IngestRecord& record);
+bool parseIngestLine(const string& line, IngestRecord& record);
+void ingestProducer(istream* in, atomic<int>* activeProducers);
+void applyIngestRecord(const IngestRecord& record, IngestStats& stats);
+void applyIngestQueue(const atomic<int>& activeProducers, IngestStats& stats);
+int runIngest(int fileCount, char* files[]);
+void benchIngestProducer(int count, bool locked, atomic<int>* activeProducers);
+int runIngestBenchmark(int records);
+
+// Near-duplicate detection
+unsigned long long mixBits(unsigned long long x);
+const unsigned long long* minHashCoefficients();
+bool addWordsToSignature(const char* text, size_t length, unsigned int* minHash);
+bool signCase(int caseId, const Text& title, const char* description, size_t length, CaseSignature& out);
+double signatureSimilarity(const CaseSignature& a, const CaseSignature& b);
+unsigned int bandKey(const CaseSignature& s, int band);
+void insertBands(const CaseSignature& s);
+void rebuildBandTable();
+void rememberCaseSignature(const CaseSignature& s);
+void forgetCaseSignature(int caseId);
+DuplicateMatch findDuplicateCase(const CaseSignature& s);
+bool recordDescription(istream& in, streamoff offset, string& description);
+void signCaseRange(int begin, int end, CaseList<CaseSignature>* out);
+int buildDuplicateIndex();
+void matchSignatureRange(int begin, int end, CaseList<DuplicateMatch>* out);
+int runDuplicateScan();
+
+// Shared-memory replica
+bool createReplicaSegment(size_t capacity);
+void closeReplica();
+unsigned int appendReplicaString(string& image, const char* text, size_t length);
+unsigned int appendReplicaString(string& image, const string& text);
+void writeReplicaCase(const Case& c, size_t at);
+void writeReplicaManagers();
+void buildReplicaImage();
+bool patchReplicaImage(ReplicaPatch patches[], int& patchCount);
+void publishReplica();
+void openReplica();
+bool readReplica(string& image, ReplicaState& state, string& error);
+const char* replicaString(const string& image, unsigned int offset, size_t& length);
+string replicaString(const string& image, unsigned int offset);
+void loadReplicaImage(const string& image, const ReplicaState& state);
+int runReplicaReport(const string& format, const string& fields, const string& target);
+
+// Edit history
+void writeHistoryText(string& out, const string& text);
+bool readHistoryText(istream& in, string& text);
+string formatRevision(const Revision& r);
+bool readRevision(istream& in, Revision& r);
+void diffField(const string& before, const string& after, FieldChange& change);
+bool applyFieldChange(string& value, const FieldChange& change);
+bool indexRevision(const Revision& r, streamoff offset);
+void openHistory();
+bool appendRevision(const Revision& r);
+bool rebuildRevision(int entry, string values[HISTORY_FIELDS], Revision& last);
+void recordCaseEdit(const Case& c, const string before[HISTORY_FIELDS]);
+int findRevision(int caseId, int number);
+int findRevisionAsOf(int caseId, PackedDate date, PackedTime time);
+bool currentCaseFields(int caseId, string values[HISTORY_FIELDS], Case& summary);
+bool parseHistoryTime(const string& text, PackedDate& date, PackedTime& time);
+void printHistoryFields(const string values[HISTORY_FIELDS]);
+bool printCaseHistory(int caseId);
+bool printCaseAsOf(int caseId, PackedDate date, PackedTime time);
+bool printRevisionDiff(int caseId, int from, int to);
+void caseHistoryMenu();
+int runHistoryCommand(int argCount, char* args[]);
+
+// Change feed
+void appendJson(string& out, const char* text, size_t length);
+string jsonString(const string& text);
+void emitChange(const char* type, const string& fields, long long sequence = 0);
+long long changeSequenceOf(const string& line);
+long long changeLoggedThrough(const string& line);
+void noteChangesDurable(long long sequence);
+void startChangeFeed(const string& sinkTarget);
+void stopChangeFeed();
+void changeFeedLoop();
+int printChangesSince(long long sequence);
+
+// Delta exports
+long long stampCase(Case& c);
+long long stampManager(Manager& m);
+long long addTombstone(int caseId, const string& managerName, bool archived = false);
+void rebuildModificationIndex();
+void writeModifiedLine(ostream& out, long long seq, const PackedDate& date, const PackedTime& time);
+bool parseModifiedLine(const string& line, long long& seq, PackedDate& date, PackedTime& time);
+void writeTombstone(ostream& out, const Tombstone& t);
+void parseTombstone(const string& line);
+void loadChangeSequence();
+int exportChangesSince(long long since, bool csv, ostream& out);
+void exportChangesMenu();
+int runBatchExport(long long since, const string& format);
+
+// Text scanning
+const TextScanner* selectTextScanner();
+const char* scanForByte(const char* p, const char* end, char c);
+const char* scanForToken(const char* p, const char* end, const char* token);
+size_t findField(const string& line, const char* token, size_t from = 0);
+bool startsWith(const string& line, const char* prefix);
+bool readWholeFile(const string& filename, string& contents);
+const char* nextLine(const char* p, const char* end, const char*& lineEnd);
+bool readLine(istream& in, string& line);
+int runScanBenchmark(const string& filename);
+
+// Compact field storage
+unsigned int internString(const string& text, bool insert = true);
+bool operator==(const Symbol& a, const Symbol& b);
+bool operator==(const Symbol& a, const string& b);
+bool operator==(const Symbol& a, const char* b);
+bool operator!=(const Symbol& a, const char* b);
+ostream& operator<<(ostream& out, const Symbol& s);
+ostream& operator<<(ostream& out, const PackedDate& d);
+ostream& operator<<(ostream& out, const PackedTime& t);
+int runMemoryBenchmark(int count);
+int runStoreBenchmark(int count);
+char* allocateText(size_t length);
+void freeText(char* chars, size_t length);
+void releaseTextArena();
+ostream& operator<<(ostream& out, const Text& t);
+int runAllocationBenchmark(const string& filename);
+
+// Scripted session benchmark
+#if IE_POSIX
+void writeLatencyDataset(const string& dir, int count);
+void clearLatencyDirectory(const string& dir);
+size_t findArriving(const string& output, const char* text, size_t& from);
+bool runLatencySession(const string& self, const string& dir, int caseId, double* stepMs, string& failure);
+string executablePath(const char* argv0);
+#endif
+int runLatencyBenchmark(const char* argv0, int largest);
+
 
 // Utilities
 void clearInputBuffer();
 string getCurrentDate();
 string getCurrentTime();
+int daysSince(const string& date);
+int dayNumber(PackedDate date);
 int findCaseIndex(int caseId);
 int findManagerIndex(const string& managerName);
 bool isManagerAssignedToCase(const Case& c, const string& managerName);
@@ -101,10 +1182,76 @@ void printCaseSummary(const Case& c);
 bool validateAdminLogin(const string& username, const string& password);
 void addNewAdmin();
 
-int main() {
+// Chosen once at startup from the CPU's capabilities
+const TextScanner* textScanner = selectTextScanner();
+
+int main(int argc, char* argv[]) {
+    if (argc > 2 && string(argv[1]) == "--bench-scan") {
+        return runScanBenchmark(argv[2]);
+    } else if (argc > 1 && string(argv[1]) == "--bench-scan") {
+        return runScanBenchmark(DATA_FILE);
+    } else if (argc > 2 && string(argv[1]) == "--bench-memory") {
+        return runMemoryBenchmark(atoi(argv[2]));
+    } else if (argc > 1 && string(argv[1]) == "--bench-memory") {
+        return runMemoryBenchmark(100000);
+    } else if (argc > 2 && string(argv[1]) == "--bench-store") {
+        return runStoreBenchmark(atoi(argv[2]));
+    } else if (argc > 1 && string(argv[1]) == "--bench-store") {
+        return runStoreBenchmark(10000);
+    } else if (argc > 2 && string(argv[1]) == "--bench-latency") {
+        return runLatencyBenchmark(argv[0], atoi(argv[2]));
+    } else if (argc > 1 && string(argv[1]) == "--bench-latency") {
+        return runLatencyBenchmark(argv[0], 0);
+    } else if (argc > 2 && string(argv[1]) == "--bench-ingest") {
+        return runIngestBenchmark(atoi(argv[2]));
+    } else if (argc > 1 && string(argv[1]) == "--bench-ingest") {
+        return runIngestBenchmark(200000);
+    } else if (argc > 2 && string(argv[1]) == "--bench-alloc") {
+        return runAllocationBenchmark(argv[2]);
+    } else if (argc > 1 && string(argv[1]) == "--bench-alloc") {
+        return runAllocationBenchmark(DATA_FILE);
+    } else if (argc > 2 && string(argv[1]) == "--query") {
+        return runBatchQuery(argv[2]);
+    } else if (argc > 2 && string(argv[1]) == "--changes-since") {
+        return printChangesSince(atoll(argv[2]));
+    } else if (argc > 2 && (string(argv[1]) == "--report" || string(argv[1]) == "--report-archive")) {
+        return runBatchReport(argv[2], argc > 3 && string(argv[3]) != "-" ? argv[3] : "", argc > 4 ? argv[4] : "-",
+                              string(argv[1]) == "--report-archive");
+    } else if (argc > 2 && string(argv[1]) == "--report-from-shm") {
+        return runReplicaReport(argv[2], argc > 3 && string(argv[3]) != "-" ? argv[3] : "", argc > 4 ? argv[4] : "-");
+    } else if (argc > 2 && string(argv[1]) == "--export-changes") {
+        return runBatchExport(atoll(argv[2]), argc > 3 ? argv[3] : "json");
+    } else if (argc > 2 && string(argv[1]) == "--history") {
+        return runHistoryCommand(argc - 2, argv + 2);
+    } else if (argc > 1 && string(argv[1]) == "--duplicates") {
+        return runDuplicateScan();
+    } else if (argc > 2 && string(argv[1]) == "--ingest") {
+        return runIngest(argc - 2, argv + 2);
+    }
+
+    string sinkTarget;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (string(argv[i]) == "--cdc") {
+            sinkTarget = argv[i + 1];
+        }
+    }
+
     loadData();
+    openHistory();
+    buildDuplicateIndex();
+    startChangeFeed(sinkTarget);
+    int archived = archiveClosedCases(ARCHIVE_AFTER_DAYS);
+    if (archived > 0) {
+        cout << archived << " closed cases moved to the archive." << endl;
+    }
+    openReplica();
+    startAutosave();
     login();
+    stopAutosave();
+    if (reportThread.joinable()) reportThread.join();
     saveData();
+    stopChangeFeed(); // After the save, which lets it log the session's last events
+    closeReplica();
     return 0;
 }
 
@@ -138,172 +1285,1232 @@ string getCurrentTime() {
     return string(buffer);
 }
 
-bool validateAdminLogin(const string& username, const string& password) {
-    ifstream credFile("Admins.txt");
-    if (!credFile) {
-        cerr << "Error: Admin credentials file not found!" << endl;
-        return false;
+// Whole days from a YYYY-MM-DD date until today, or -1 if unparseable
+int daysSince(const string& date) {
+    tm then = {};
+    if (sscanf(date.c_str(), "%d-%d-%d", &then.tm_year, &then.tm_mon, &then.tm_mday) != 3) {
+        return -1;
     }
+    then.tm_year -= 1900;
+    then.tm_mon -= 1;
+    then.tm_hour = 12; // Midday keeps DST shifts from changing the day count
+    time_t thenTime = mktime(&then);
+    if (thenTime == -1) return -1;
+    return (int)(difftime(time(0), thenTime) / (24 * 60 * 60));
+}
 
-    string line;
-    while (getline(credFile, line)) {
-        size_t colonPos = line.find(':');
-        if (colonPos != string::npos) {
-            string storedUsername = line.substr(0, colonPos);
-            string storedPassword = line.substr(colonPos + 1);
-            if (username == storedUsername && password == storedPassword) {
-                return true;
-            }
-        }
+// Compact field storage. Dates and times are packed into integers and the
+// short repeated strings are interned, so a case costs a few bytes per field
+// instead of a std::string each.
+// Returns the pool index of text, adding it unless insert is false (then
+// 0 means not present)
+unsigned int symbolHash(const string& text) {
+    unsigned int hash = 2166136261u; // FNV-1a
+    for (size_t i = 0; i < text.length(); i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
     }
-    return false;
+    return hash;
 }
 
-void addNewAdmin() {
-    if (currentUserIsManager) {
-        cout << "Only admins can add other admins." << endl;
-        return;
+const string& symbolText(unsigned int id) {
+    return symbolChunks[id / SYMBOL_CHUNK_SIZE][id % SYMBOL_CHUNK_SIZE];
+}
+
+// Doubles the slot array and reinserts every symbol; symbolMutex is held
+void growSymbolSlots() {
+    unsigned int count = symbolSlotCount == 0 ? 2 * SYMBOL_CHUNK_SIZE : 2 * symbolSlotCount;
+    unsigned int* slots = new unsigned int[count]();
+    for (unsigned int id = 1; id < symbolCount; id++) {
+        unsigned int slot = symbolHash(symbolText(id)) & (count - 1);
+        while (slots[slot] != 0) slot = (slot + 1) & (count - 1);
+        slots[slot] = id;
     }
+    delete[] symbolSlots;
+    symbolSlots = slots;
+    symbolSlotCount = count;
+}
 
-    ofstream credFile("Admins.txt", ios::app);
-    if (!credFile) {
-        cerr << "Error opening credentials file!" << endl;
-        return;
+unsigned int internString(const string& text, bool insert) {
+    if (text.empty()) return 0;
+    unsigned int hash = symbolHash(text);
+    lock_guard<mutex> lock(symbolMutex);
+    if (2 * (symbolCount + 1) > symbolSlotCount) growSymbolSlots();
+    const unsigned int mask = symbolSlotCount - 1;
+    for (unsigned int slot = hash & mask; ; slot = (slot + 1) & mask) {
+        unsigned int id = symbolSlots[slot];
+        if (id == 0) {
+            if (!insert) return 0;
+            if (symbolCount == (unsigned int)MAX_SYMBOL_CHUNKS * SYMBOL_CHUNK_SIZE) {
+                // A billion distinct strings; memory runs out long before this
+                cerr << "Symbol table full; cannot store \"" << text << "\"." << endl;
+                abort();
+            }
+            string*& chunk = symbolChunks[symbolCount / SYMBOL_CHUNK_SIZE];
+            if (chunk == nullptr) chunk = new string[SYMBOL_CHUNK_SIZE];
+            chunk[symbolCount % SYMBOL_CHUNK_SIZE] = text;
+            symbolSlots[slot] = symbolCount;
+            return symbolCount++;
+        }
+        if (symbolText(id) == text) return id;
     }
+}
 
-    string username, password;
-    cout << "Enter new admin username: ";
-    getline(cin, username);
-    cout << "Enter new admin password: ";
-    getline(cin, password);
+Symbol::Symbol(const string& text) : id(internString(text)) {}
+Symbol::Symbol(const char* text) : id(internString(text)) {}
 
-    if (validateAdminLogin(username, password)) { // Prevent duplicate admin entries
-        cout << "Admin already exists!" << endl;
-        return;
+const string& Symbol::str() const {
+    return symbolText(id);
+}
+
+bool operator==(const Symbol& a, const Symbol& b) { return a.id == b.id; }
+bool operator==(const Symbol& a, const string& b) { return a.str() == b; }
+bool operator==(const Symbol& a, const char* b) { return a.str() == b; }
+bool operator!=(const Symbol& a, const char* b) { return a.str() != b; }
+
+ostream& operator<<(ostream& out, const Symbol& s) {
+    return out << s.str();
+}
+
+// Parses exactly `count` digits at p, or returns -1
+int parseFixedDigits(const char* p, int count) {
+    int value = 0;
+    for (int i = 0; i < count; i++) {
+        if (p[i] < '0' || p[i] > '9') return -1;
+        value = value * 10 + (p[i] - '0');
     }
+    return value;
+}
 
-    credFile << username << ":" << password << endl;
-    cout << "Admin added successfully." << endl;
+PackedDate::PackedDate(const string& text) {
+    if (text.length() != 10 || text[4] != '-' || text[7] != '-') return;
+    int year = parseFixedDigits(text.data(), 4);
+    int month = parseFixedDigits(text.data() + 5, 2);
+    int day = parseFixedDigits(text.data() + 8, 2);
+    if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31) return;
+    value = year * 10000 + month * 100 + day;
 }
 
-void adminMainMenu() {
-    while (true) {
-        cout << "\n=== Admin Main Menu ===" << endl;
-        cout << "1. Case Management" << endl;
-        cout << "2. Manager Management" << endl;
-        cout << "3. Reports" << endl;
-        cout << "4. Add New Admin" << endl;
-        cout << "5. Logout" << endl;
-        cout << "Enter your choice: ";
-        
-        int choice;
-        cin >> choice;
-        clearInputBuffer();
-        
-        switch (choice) {
-            case 1: caseManagementMenu(); break;
-            case 2: managerManagementMenu(); break;
-            case 3: reportMenu(); break;
-            case 4: addNewAdmin(); break;
-            case 5: return;
-            default: cout << "Invalid choice!" << endl;
-        }
+// Writes count digits of value, zero-padded
+void formatFixedDigits(char* p, unsigned int value, int count) {
+    for (int i = count - 1; i >= 0; i--) {
+        p[i] = (char)('0' + value % 10);
+        value /= 10;
     }
 }
 
-void login() {
-    while (true) {
-        cout << "=== IE System Login ===" << endl;
-        cout << "1. Login as Admin" << endl;
-        cout << "2. Login as Manager" << endl;
-        cout << "3. Exit" << endl;
-        cout << "Enter your choice: ";
-        
-        int choice;
-        cin >> choice;
-        clearInputBuffer();
-        
-        if (choice == 3) {
-            cout << "Exiting system..." << endl;
-            exit(0);
-        }
+size_t PackedDate::format(char* buffer) const {
+    if (empty()) return 0;
+    formatFixedDigits(buffer, value / 10000, 4);
+    buffer[4] = '-';
+    formatFixedDigits(buffer + 5, value / 100 % 100, 2);
+    buffer[7] = '-';
+    formatFixedDigits(buffer + 8, value % 100, 2);
+    return 10;
+}
 
-        if (choice == 1) {
-            string username, password;
-            cout << "Enter admin username: ";
-            getline(cin, username);
-            cout << "Enter admin password: ";
-            getline(cin, password);
+string PackedDate::str() const {
+    char buffer[10];
+    return string(buffer, format(buffer));
+}
 
-            if (!validateAdminLogin(username, password)) {
-                cout << "Invalid admin credentials. Access denied." << endl;
-                continue;
-            }
+ostream& operator<<(ostream& out, const PackedDate& d) {
+    if (out.width() > 0) return out << d.str(); // Let setw pad as for strings
+    char buffer[10];
+    return out.write(buffer, d.format(buffer));
+}
 
-            currentUser = username;
-            currentUserIsManager = false;
-            cout << "Welcome, Admin " << currentUser << "!" << endl;
-            adminMainMenu();
-            return;
-        }
-        else if (choice == 2) {
-            string managerName, password;
-            cout << "Enter your name: ";
-            getline(cin, managerName);
-            
-            int managerIndex = findManagerIndex(managerName);
-            if (managerIndex == -1) {
-                cout << "Manager not found. Access denied." << endl;
-                continue;
-            }
-            
-            if (!managers[managerIndex].active) {
-                cout << "Your account is inactive. Please contact admin." << endl;
-                continue;
-            }
+PackedTime::PackedTime(const string& text) {
+    if (text.length() != 8 || text[2] != ':' || text[5] != ':') return;
+    int hours = parseFixedDigits(text.data(), 2);
+    int minutes = parseFixedDigits(text.data() + 3, 2);
+    int seconds = parseFixedDigits(text.data() + 6, 2);
+    if (hours < 0 || hours > 23 || minutes < 0 || minutes > 59 || seconds < 0 || seconds > 59) return;
+    value = hours * 3600 + minutes * 60 + seconds;
+}
 
-            cout << "Enter your password: ";
-            getline(cin, password);
-            
-            if (password != managers[managerIndex].password) {
-                cout << "Invalid password. Access denied." << endl;
-                continue;
+size_t PackedTime::format(char* buffer) const {
+    if (empty()) return 0;
+    formatFixedDigits(buffer, value / 3600, 2);
+    buffer[2] = ':';
+    formatFixedDigits(buffer + 3, value / 60 % 60, 2);
+    buffer[5] = ':';
+    formatFixedDigits(buffer + 6, value % 60, 2);
+    return 8;
+}
+
+string PackedTime::str() const {
+    char buffer[8];
+    return string(buffer, format(buffer));
+}
+
+ostream& operator<<(ostream& out, const PackedTime& t) {
+    if (out.width() > 0) return out << t.str();
+    char buffer[8];
+    return out.write(buffer, t.format(buffer));
+}
+
+void noteUnpackableField(const string& text) {
+    if (unpackableFields.fetch_add(1) == 0) firstUnpackableField = text;
+}
+
+void loadDateField(PackedDate& date, const string& text) {
+    date = text;
+    if (date.empty() && !text.empty()) noteUnpackableField(text);
+}
+
+void loadTimeField(PackedTime& time, const string& text) {
+    time = text;
+    if (time.empty() && !text.empty()) noteUnpackableField(text);
+}
+
+// Text pool. Size class k holds blocks of 16 << k bytes; longer text than
+// the largest class goes straight to the heap.
+int textSizeClass(size_t length) {
+    int sizeClass = 0;
+    while (sizeClass < TEXT_SIZE_CLASSES && ((size_t)16 << sizeClass) < length) sizeClass++;
+    return sizeClass < TEXT_SIZE_CLASSES ? sizeClass : -1;
+}
+
+char* allocateText(size_t length) {
+    int sizeClass = textSizeClass(length);
+    if (sizeClass < 0) return new char[length];
+
+    size_t blockSize = (size_t)16 << sizeClass;
+    lock_guard<mutex> lock(textPoolMutex);
+    char* block = textFreeLists[sizeClass];
+    if (block) {
+        memcpy(&textFreeLists[sizeClass], block, sizeof(char*));
+        return block;
+    }
+    if (!textChunk || textChunkUsed + blockSize > TEXT_CHUNK_SIZE) {
+        char* chunk = (char*)malloc(TEXT_CHUNK_SIZE);
+        if (!chunk) throw bad_alloc();
+        memcpy(chunk, &textChunk, sizeof(char*));
+        textChunk = chunk;
+        textChunkUsed = 16; // Link to the previous chunk, padded for alignment
+        textChunkCount++;
+    }
+    block = textChunk + textChunkUsed;
+    textChunkUsed += blockSize;
+    return block;
+}
+
+void freeText(char* chars, size_t length) {
+    if (!chars) return;
+    int sizeClass = textSizeClass(length);
+    if (sizeClass < 0) {
+        delete[] chars;
+        return;
+    }
+    lock_guard<mutex> lock(textPoolMutex);
+    memcpy(chars, &textFreeLists[sizeClass], sizeof(char*));
+    textFreeLists[sizeClass] = chars;
+}
+
+// Frees every arena chunk at once. Only valid when no pooled Text is alive.
+void releaseTextArena() {
+    lock_guard<mutex> lock(textPoolMutex);
+    while (textChunk) {
+        char* previous;
+        memcpy(&previous, textChunk, sizeof(char*));
+        free(textChunk);
+        textChunk = previous;
+    }
+    textChunkUsed = 0;
+    for (int i = 0; i < TEXT_SIZE_CLASSES; i++) textFreeLists[i] = nullptr;
+}
+
+Text& Text::operator=(const Text& other) {
+    if (this != &other) assign(other.chars, other.size);
+    return *this;
+}
+
+Text::~Text() {
+    freeText(chars, size);
+}
+
+void Text::assign(const char* text, size_t length) {
+    if (length == 0) {
+        freeText(chars, size);
+        chars = nullptr;
+    } else if (chars && textSizeClass(length) == textSizeClass(size) && textSizeClass(length) >= 0) {
+        memmove(chars, text, length); // Same block fits; text may alias it
+    } else {
+        char* block = allocateText(length);
+        memcpy(block, text, length);
+        freeText(chars, size);
+        chars = block;
+    }
+    size = (unsigned int)length;
+}
+
+void Text::swap(Text& other) noexcept {
+    std::swap(chars, other.chars);
+    std::swap(size, other.size);
+}
+
+ostream& operator<<(ostream& out, const Text& t) {
+    if (out.width() > 0) return out << t.str(); // Let setw pad as for strings
+    return out.write(t.chars, t.size);
+}
+
+#if IE_BENCH_ALLOC
+// Counting replacement for the global allocator, used by --bench-alloc.
+// It and the deletes are kept out of line: inlined into a new-expression's
+// caller, the free() would no longer be seen to pair with the malloc().
+__attribute__((noinline)) void* operator new(size_t size) {
+    heapAllocationCount.fetch_add(1, memory_order_relaxed);
+    void* p = malloc(size ? size : 1);
+    if (!p) throw bad_alloc();
+    return p;
+}
+
+__attribute__((noinline)) void operator delete(void* p) noexcept {
+    free(p);
+}
+
+__attribute__((noinline)) void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+#endif
+
+// Parses every case record in the file with its body, the way loadCaseBody
+// does, and reports the heap allocations and arena chunks that took.
+int runAllocationBenchmark(const string& filename) {
+    string contents;
+    if (!readWholeFile(filename, contents)) {
+        cerr << "Cannot read " << filename << endl;
+        return 1;
+    }
+    streamoff offsets[MAX_CASES];
+    int offsetCount = 0;
+    const char* start = contents.data();
+    const char* end = start + contents.size();
+    for (const char* p = start; p < end && offsetCount < MAX_CASES; ) {
+        const char* lineEnd;
+        const char* next = nextLine(p, end, lineEnd);
+        if (lineEnd - p >= 9 && memcmp(p, "Case ID: ", 9) == 0) offsets[offsetCount++] = p - start;
+        p = next;
+    }
+    if (offsetCount == 0) {
+        cerr << "No case records in " << filename << endl;
+        return 1;
+    }
+
+    const int ROUNDS = 2000;
+    istringstream in(contents);
+    Case* store = new Case[offsetCount];
+    long long allocationsBefore = heapAllocationCount.load();
+    long long chunksBefore = textChunkCount;
+    auto started = chrono::steady_clock::now();
+    for (int round = 0; round < ROUNDS; round++) {
+        for (int i = 0; i < offsetCount; i++) {
+            Case record;
+            readCaseRecord(in, offsets[i], record);
+            store[i].description.swap(record.description);
+            for (int a = 0; a < record.actionCount; a++) {
+                store[i].actions[a].description.swap(record.actions[a].description);
             }
+        }
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+    long long allocations = heapAllocationCount.load() - allocationsBefore;
+    long long records = (long long)ROUNDS * offsetCount;
+
+    cout << "Parsed " << records << " case records with bodies in " << seconds * 1000 << " ms" << endl;
+#if IE_BENCH_ALLOC
+    cout << "Heap allocations: " << allocations << " (" << (double)allocations / records << " per record)" << endl;
+#else
+    (void)allocations;
+    cout << "Heap allocations: not counted in this build (compile with -DIE_BENCH_ALLOC=1)" << endl;
+#endif
+    cout << "Text arena chunks: " << textChunkCount - chunksBefore << endl;
+    delete[] store;
+    releaseTextArena();
+    return 0;
+}
 
-            currentUser = managerName;
-            currentUserIsManager = true;
-            cout << "Welcome, Manager " << currentUser << "!" << endl;
-            mainMenu();
-            return;
+// Resident set size in KB, or -1 where /proc is not available
+long residentKb() {
+    ifstream status("/proc/self/status");
+    string line;
+    while (getline(status, line)) {
+        if (startsWith(line, "VmRSS:")) return atol(line.c_str() + 6);
+    }
+    return -1;
+}
+
+// Times one RecordStore configuration: appending count cases, random
+// lookups by ID, and erasing from the middle
+template <class Store>
+void benchmarkStore(const char* name, int count, bool active) {
+    Store* store = new Store();
+    Case c;
+    c.title = "Printer offline";
+    c.source = "Email";
+
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    for (int i = 0; i < count && !store->full(); i++) {
+        c.id = 1000 + i;
+        store->append(c);
+    }
+    double appendMs = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    int stored = store->size();
+
+    const int lookups = 200000;
+    unsigned int random = 12345;
+    long long found = 0;
+    begin = chrono::steady_clock::now();
+    for (int i = 0; i < lookups; i++) {
+        random = random * 1103515245u + 12345u;
+        found += store->find(1000 + (int)(random % (unsigned int)(stored + stored / 8 + 1))) >= 0;
+    }
+    double lookupNs = chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count() / lookups;
+
+    const int erases = min(100, stored / 2);
+    begin = chrono::steady_clock::now();
+    for (int i = 0; i < erases; i++) store->erase(store->size() / 2);
+    double eraseMs = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+
+    char line[160];
+    // Printing the hit rate also keeps the lookups from being optimized away
+    snprintf(line, sizeof(line), "%-15s %8d %11.2f %11.1f %6.1f%% %10.2f %12.1f%s", name, stored, appendMs,
+             lookupNs, 100.0 * found / lookups, eraseMs, store->bytes() / 1024.0, active ? "  <- this build" : "");
+    cout << line << endl;
+    delete store;
+}
+
+// --bench-store [count]: every storage and index policy side by side. The
+// inline configurations hold at most BENCH_INLINE_CAPACITY cases.
+int runStoreBenchmark(int count) {
+    if (count <= 0) {
+        cerr << "Case count must be positive" << endl;
+        return 1;
+    }
+    const int BENCH_INLINE_CAPACITY = 20000;
+    typedef InlineStorage<BENCH_INLINE_CAPACITY> BenchInline;
+    char line[160];
+    snprintf(line, sizeof(line), "%-15s %8s %11s %11s %7s %10s %12s", "Storage/index", "Cases", "Append ms",
+             "Lookup ns", "Hits", "Erase ms", "Footprint KB");
+    cout << line << endl;
+    benchmarkStore<RecordStore<Case, BenchInline, ScanIndex<int> > >("inline + scan", count,
+                                                                    !IE_STORE_DYNAMIC && !IE_STORE_INDEXED);
+    benchmarkStore<RecordStore<Case, BenchInline, HashIndex<int> > >("inline + hash", count,
+                                                                    !IE_STORE_DYNAMIC && IE_STORE_INDEXED);
+    benchmarkStore<RecordStore<Case, HeapStorage, ScanIndex<int> > >("heap + scan", count,
+                                                                    IE_STORE_DYNAMIC && !IE_STORE_INDEXED);
+    benchmarkStore<RecordStore<Case, HeapStorage, HashIndex<int> > >("heap + hash", count,
+                                                                    IE_STORE_DYNAMIC && IE_STORE_INDEXED);
+    cout << "This build: MAX_CASES " << MAX_CASES << (IE_STORE_DYNAMIC ? " (inline only)" : "")
+         << ", MAX_ACTIONS " << MAX_ACTIONS << ", sizeof(Case) " << sizeof(Case) << " bytes" << endl;
+    return 0;
+}
+
+// Scripted interactive sessions. Each step sends one input line to a child
+// copy of the app and waits for the prompt that ends it; the child runs in a
+// scratch directory holding a generated dataset.
+#if IE_POSIX
+const LatencyStep LATENCY_SCRIPT[] = {
+    { nullptr, "Enter your choice: ", "cases and", "startup" },
+    { "1", "username: ", nullptr, nullptr },
+    { "bench", "password: ", nullptr, nullptr },
+    { "bench", "Enter your choice: ", "Welcome, Admin", "login" },
+    { "1", "Enter your choice: ", "=== Case Management ===", nullptr },
+    { "2", "Enter your choice: ", "=== Case Details ===", "view all cases" },
+    { "3", "Case ID: ", nullptr, nullptr },
+    { "#", "Enter your choice: ", "Description: ", "case details" },
+    { "10", "Enter query: ", nullptr, nullptr },
+    { "status=Open|Assigned source=Email", "Enter your choice: ", "matching cases", "query" },
+    { "7", "Case ID: ", nullptr, nullptr },
+    { "#", "description: ", nullptr, nullptr },
+    { "Called reporter back", "Enter your choice: ", "Action added successfully", "add action" },
+    { "1", "title: ", nullptr, nullptr },
+    { "Latency probe", "description: ", nullptr, nullptr },
+    { "Added by the latency benchmark", "source: ", nullptr, nullptr },
+    { "Web", "Enter your choice: ", "Case added successfully", "add case" },
+    { "11", "for any): ", nullptr, nullptr },
+    { "", "Enter your choice: ", nullptr, "auto-assign" },
+    { "13", "Enter your choice: ", "=== Admin Main Menu ===", nullptr },
+    { "2", "Enter your choice: ", "=== Manager Management ===", nullptr },
+    { "2", "Enter your choice: ", "Alice", "view managers" },
+    { "6", "Enter your choice: ", nullptr, nullptr },
+    { "3", "Enter your choice: ", "=== Reports ===", nullptr },
+    { "1", "Enter your choice: ", "Report generated: ", "case report" },
+    { "6", "Enter your choice: ", "SLA report generated: ", "SLA report" },
+    { "8", "Enter your choice: ", nullptr, nullptr },
+    { "5", nullptr, "Data saved", "logout and save" },
+};
+const int LATENCY_STEP_COUNT = sizeof(LATENCY_SCRIPT) / sizeof(LATENCY_SCRIPT[0]);
+
+// Writes Admins.txt and a dataset of `count` cases into dir: eight managers
+// in three departments, every status, and up to three actions per case, all
+// dated today so that nothing is archived at startup
+void writeLatencyDataset(const string& dir, int count) {
+    const char* names[] = { "Alice", "Bob", "Carol", "Dan", "Erin", "Frank", "Grace", "Heidi" };
+    const char* departments[] = { "Network", "Security", "Ops" };
+    const char* sources[] = { "Email", "Phone", "Walk-in", "Web" };
+    const char* statuses[] = { "Open", "Assigned", "In Progress", "Exported", "Closed" };
+    const int managerCount = min(8, MAX_MANAGERS);
+    string today = getCurrentDate();
+
+    ofstream admins((dir + "/Admins.txt").c_str());
+    admins << "bench:bench\n";
+
+    ofstream out((dir + "/" + DATA_FILE).c_str(), ios::binary);
+    out << "=== MANAGERS ===\n";
+    for (int i = 0; i < managerCount; i++) {
+        out << "Manager " << i + 1 << ":\n  Name: " << names[i] << "\n  Department: " << departments[i % 3]
+            << "\n  Password: " << names[i] << "\n  Status: Active\n\n";
+    }
+    out << "=== CASES ===\n";
+    char time[16];
+    for (int i = 0; i < count; i++) {
+        int status = i % 5;
+        snprintf(time, sizeof(time), "%02d:%02d:%02d", 8 + i / 3600 % 10, i / 60 % 60, i % 60);
+        out << "Case ID: " << 1000 + i << "\n  Title: Printer offline in building " << i % 40
+            << "\n  Description: Reported by front desk; needs on-site visit #" << i
+            << "\n  Created: " << today << " at " << time << "\n  Source: " << sources[i % 4]
+            << "\n  Status: " << statuses[status] << "\n";
+        int assigned = status == 0 ? 0 : min(2, MAX_ASSIGNED_MANAGERS);
+        out << "  Assigned Managers (" << assigned << "):\n";
+        for (int a = 0; a < assigned; a++) out << "    - " << names[(i + a) % managerCount] << "\n";
+        int actions = status < 2 ? 0 : min(3, MAX_ACTIONS);
+        out << "  Actions (" << actions << "):\n";
+        for (int a = 0; a < actions; a++) {
+            out << "    - " << today << " " << time << " by " << names[i % managerCount]
+                << ": Called reporter and updated ticket, step " << a << "\n";
         }
-        else {
-            cout << "Invalid choice. Please try again." << endl;
+        out << "\n";
+    }
+    out << "=== SYSTEM ===\nNext Case ID: " << 1000 + count << "\n";
+}
+
+// Removes everything a session left in dir (data, journal, change log,
+// archive segments, reports)
+void clearLatencyDirectory(const string& dir) {
+    DIR* listing = opendir(dir.c_str());
+    if (listing == nullptr) return;
+    while (dirent* entry = readdir(listing)) {
+        if (strcmp(entry->d_name, ".") != 0 && strcmp(entry->d_name, "..") != 0) {
+            unlink((dir + "/" + entry->d_name).c_str());
         }
     }
+    closedir(listing);
 }
 
-void mainMenu() {
+// Position of text in output at or after from, or npos. from is advanced
+// past what has been searched, so output that grows between calls is
+// scanned once.
+size_t findArriving(const string& output, const char* text, size_t& from) {
+    size_t found = output.find(text, from);
+    if (found == string::npos) {
+        size_t keep = strlen(text) - 1;
+        from = max(from, output.size() > keep ? output.size() - keep : 0);
+    }
+    return found;
+}
+
+// Runs LATENCY_SCRIPT against `self` started in dir. Fills stepMs with the
+// time from sending each labelled step's input to its closing prompt (or to
+// exit), and returns false with a description of the first step whose
+// prompt or expected output did not appear.
+bool runLatencySession(const string& self, const string& dir, int caseId, double* stepMs, string& failure) {
+    int toChild[2], fromChild[2];
+    if (pipe(toChild) != 0) {
+        failure = string("pipe: ") + strerror(errno);
+        return false;
+    }
+    if (pipe(fromChild) != 0) {
+        failure = string("pipe: ") + strerror(errno);
+        close(toChild[0]);
+        close(toChild[1]);
+        return false;
+    }
+    pid_t pid = fork();
+    if (pid < 0) {
+        failure = string("fork: ") + strerror(errno);
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        return false;
+    }
+    if (pid == 0) {
+        dup2(toChild[0], 0);
+        dup2(fromChild[1], 1);
+        dup2(fromChild[1], 2);
+        close(toChild[0]);
+        close(toChild[1]);
+        close(fromChild[0]);
+        close(fromChild[1]);
+        if (chdir(dir.c_str()) == 0) execl(self.c_str(), self.c_str(), (char*)nullptr);
+        _exit(127);
+    }
+    close(toChild[0]);
+    close(fromChild[1]);
+
+    string output;
+    size_t stepStart = 0;
+    char buffer[64 * 1024];
+    int timed = 0;
+    bool ok = true;
+    for (int i = 0; ok && i < LATENCY_STEP_COUNT; i++) {
+        const LatencyStep& step = LATENCY_SCRIPT[i];
+        chrono::steady_clock::time_point sent = chrono::steady_clock::now();
+        if (step.input != nullptr) {
+            string line = strcmp(step.input, "#") == 0 ? to_string(caseId) : string(step.input);
+            line += '\n';
+            if (write(toChild[1], line.data(), line.size()) != (ssize_t)line.size()) {
+                failure = "input refused";
+                ok = false;
+                break;
+            }
+        }
+
+        // Only text arriving after the previous step can close this one
+        size_t untilFrom = stepStart, expectFrom = stepStart;
+        size_t untilAt = string::npos, expectAt = string::npos;
+        bool exited = false;
+        while (true) {
+            if (step.until != nullptr && untilAt == string::npos) untilAt = findArriving(output, step.until, untilFrom);
+            if (step.expect != nullptr && expectAt == string::npos) {
+                expectAt = findArriving(output, step.expect, expectFrom);
+            }
+            if (step.until != nullptr && untilAt != string::npos && (step.expect == nullptr || expectAt != string::npos)) {
+                break;
+            }
+            pollfd ready = { fromChild[0], POLLIN, 0 };
+            if (poll(&ready, 1, LATENCY_TIMEOUT_MS) <= 0) break;
+            ssize_t received = read(fromChild[0], buffer, sizeof(buffer));
+            if (received <= 0) {
+                exited = true;
+                break;
+            }
+            output.append(buffer, received);
+        }
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - sent).count();
+
+        size_t stepEnd = output.size();
+        if (step.until != nullptr && untilAt != string::npos) {
+            stepEnd = untilAt + strlen(step.until);
+            if (expectAt != string::npos) stepEnd = max(stepEnd, expectAt + strlen(step.expect));
+        }
+        const char* label = step.label != nullptr ? step.label : (step.input != nullptr ? step.input : "(start)");
+        if (step.until != nullptr ? untilAt == string::npos : !exited) {
+            failure = string("step \"") + label + "\": " +
+                (step.until != nullptr ? string("no \"") + step.until + "\" prompt" : string("app did not exit"));
+            ok = false;
+        } else if (step.expect != nullptr && expectAt == string::npos) {
+            failure = string("step \"") + label + "\": output lacks \"" + step.expect + "\"";
+            ok = false;
+        }
+        if (!ok) {
+            size_t tail = min<size_t>(stepEnd - stepStart, 300);
+            failure += "; last output: " + output.substr(stepEnd - tail, tail);
+        }
+        if (step.label != nullptr) stepMs[timed++] = ms;
+        stepStart = stepEnd;
+    }
+
+    close(toChild[1]);
+    if (!ok) kill(pid, SIGKILL);
+    close(fromChild[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (ok && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+        failure = "app exited with status " + to_string(WIFEXITED(status) ? WEXITSTATUS(status) : -1);
+        ok = false;
+    }
+    return ok;
+}
+
+// Absolute path of the running binary, so the child can be started from
+// the scratch directory
+string executablePath(const char* argv0) {
+    char path[4096];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length > 0) return string(path, length);
+    if (realpath(argv0, path) != nullptr) return path;
+    return argv0;
+}
+#endif
+
+// --bench-latency [cases]: drives the interactive menus of this binary with
+// LATENCY_SCRIPT over datasets of cases/8, cases/4, cases/2 and all of the
+// cases, and reports per-command latency. A command whose time grows faster
+// than n^LATENCY_SUPERLINEAR between the last sizes is flagged, and any
+// flag or failed step makes the exit status non-zero.
+int runLatencyBenchmark(const char* argv0, int largest) {
+#if IE_POSIX
+    // Inline stores must keep a free slot for the "add case" step
+    const int limit = IE_STORE_DYNAMIC ? numeric_limits<int>::max() : MAX_CASES - 1;
+    if (largest <= 0) largest = IE_STORE_DYNAMIC ? 8000 : limit;
+    if (largest > limit) {
+        cerr << "This build holds at most " << MAX_CASES << " cases; using " << limit << endl;
+        largest = limit;
+    }
+    signal(SIGPIPE, SIG_IGN); // A child that dies mid-script must not end the benchmark
+    string self = executablePath(argv0);
+    const char* tmp = getenv("TMPDIR");
+    string pattern = string(tmp != nullptr && *tmp ? tmp : "/tmp") + "/ie_latency_XXXXXX";
+    if (mkdtemp(&pattern[0]) == nullptr) {
+        cerr << "Cannot create a scratch directory: " << strerror(errno) << endl;
+        return 1;
+    }
+
+    int sizes[LATENCY_SIZES];
+    double best[LATENCY_SIZES][LATENCY_STEP_COUNT];
+    int timedSteps = 0;
+    for (int i = 0; i < LATENCY_STEP_COUNT; i++) timedSteps += LATENCY_SCRIPT[i].label != nullptr;
+    bool failed = false;
+    for (int s = 0; s < LATENCY_SIZES && !failed; s++) {
+        sizes[s] = max(1, largest >> (LATENCY_SIZES - 1 - s));
+        for (int t = 0; t < timedSteps; t++) best[s][t] = numeric_limits<double>::max();
+        for (int round = 0; round < LATENCY_ROUNDS && !failed; round++) {
+            clearLatencyDirectory(pattern);
+            writeLatencyDataset(pattern, sizes[s]);
+            double stepMs[LATENCY_STEP_COUNT];
+            string failure;
+            if (!runLatencySession(self, pattern, 1000 + sizes[s] / 2, stepMs, failure)) {
+                cerr << "FAIL at " << sizes[s] << " cases: " << failure << endl;
+                failed = true;
+                break;
+            }
+            for (int t = 0; t < timedSteps; t++) best[s][t] = min(best[s][t], stepMs[t]);
+        }
+    }
+    clearLatencyDirectory(pattern);
+    rmdir(pattern.c_str());
+    if (failed) return 1;
+
+    char line[200];
+    cout << "Scripted admin session, fastest of " << LATENCY_ROUNDS << " (ms)" << endl;
+    int length = snprintf(line, sizeof(line), "%-16s", "Command");
+    for (int s = 0; s < LATENCY_SIZES; s++) {
+        length += snprintf(line + length, sizeof(line) - length, " %9s", ("n=" + to_string(sizes[s])).c_str());
+    }
+    snprintf(line + length, sizeof(line) - length, " %7s", "Growth");
+    cout << line << endl;
+
+    int flagged = 0;
+    int timed = 0;
+    for (int i = 0; i < LATENCY_STEP_COUNT; i++) {
+        if (LATENCY_SCRIPT[i].label == nullptr) continue;
+        length = snprintf(line, sizeof(line), "%-16s", LATENCY_SCRIPT[i].label);
+        for (int s = 0; s < LATENCY_SIZES; s++) {
+            length += snprintf(line + length, sizeof(line) - length, " %9.2f", best[s][timed]);
+        }
+        // Exponent k in time ~ n^k over the last two doublings, where fixed
+        // costs such as process startup matter least
+        const int from = max(0, LATENCY_SIZES - 3);
+        const int to = LATENCY_SIZES - 1;
+        double growth = 0;
+        if (sizes[to] > sizes[from] && best[from][timed] > 0) {
+            growth = log(best[to][timed] / best[from][timed]) / log((double)sizes[to] / sizes[from]);
+        }
+        bool superLinear = growth > LATENCY_SUPERLINEAR && best[to][timed] >= LATENCY_NOISE_MS;
+        flagged += superLinear;
+        snprintf(line + length, sizeof(line) - length, " %7.2f%s", growth, superLinear ? "  <- super-linear" : "");
+        cout << line << endl;
+        timed++;
+    }
+    if (flagged > 0) {
+        cout << flagged << " command(s) grow faster than n^" << LATENCY_SUPERLINEAR << endl;
+        return 1;
+    }
+    cout << "All commands scale at most n^" << LATENCY_SUPERLINEAR << endl;
+    return 0;
+#else
+    (void)argv0;
+    (void)largest;
+    cerr << "--bench-latency needs a POSIX system" << endl;
+    return 1;
+#endif
+}
+
+// Fills `count` cases shaped like typical records (three actions each) and
+// reports the memory they occupy.
+int runMemoryBenchmark(int count) {
+    if (count <= 0) {
+        cerr << "Case count must be positive" << endl;
+        return 1;
+    }
+    const char* sources[] = { "Email", "Phone", "Walk-in", "Web" };
+    const char* statuses[] = { "Open", "Assigned", "In Progress", "Exported", "Closed" };
+    const char* names[] = { "Alice", "Bob", "Carol", "Dan" };
+
+    long before = residentKb();
+    Case* store = new Case[count];
+    for (int i = 0; i < count; i++) {
+        Case& c = store[i];
+        c.id = 1000 + i;
+        c.title = "Printer offline in building " + to_string(i % 40);
+        c.description = "Reported by front desk; needs on-site visit #" + to_string(i);
+        c.creationDate = "2025-03-14";
+        c.creationTime = "09:26:53";
+        c.source = sources[i % 4];
+        c.status = statuses[i % 5];
+        c.lastActionDate = "2025-03-15";
+        c.assignedManagers[0] = names[i % 4];
+        c.assignedManagers[1] = names[(i + 1) % 4];
+        c.assignedManagerCount = 2;
+        for (int a = 0; a < 3; a++) {
+            Action& action = c.actions[a];
+            action.description = "Called reporter and updated ticket, step " + to_string(a);
+            action.date = "2025-03-15";
+            action.time = "10:00:00";
+            action.manager = names[(i + a) % 4];
+        }
+        c.actionCount = 3;
+    }
+    long after = residentKb();
+
+    cout << "sizeof(Case) = " << sizeof(Case) << " bytes, sizeof(Action) = " << sizeof(Action) << " bytes" << endl;
+    if (before < 0 || after < 0) {
+        cout << "Resident memory not available on this platform" << endl;
+    } else {
+        cout << "Resident memory for " << count << " cases: " << (after - before) / 1024 << " MB ("
+             << (after - before) * 1024 / count << " bytes per case)" << endl;
+    }
+    delete[] store;
+    return 0;
+}
+
+// Days since 1970-01-01 for a packed date, without going through mktime
+int dayNumber(PackedDate date) {
+    int year = date.value / 10000;
+    int month = date.value / 100 % 100;
+    int day = date.value % 100;
+    year -= month <= 2;
+    int era = (year >= 0 ? year : year - 399) / 400;
+    int yearOfEra = year - era * 400;
+    int dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Text scanning. The loaders split IE.txt and Admins.txt with these instead
+// of getline/string::find; the widest implementation the CPU supports is
+// picked once at startup.
+const char* findByteScalar(const char* p, const char* end, char c) {
+    const void* hit = memchr(p, c, end - p);
+    return hit ? (const char*)hit : end;
+}
+
+const char* findTokenScalar(const char* p, const char* end, const char* token, size_t length) {
+    while (end - p >= (ptrdiff_t)length) {
+        p = (const char*)memchr(p, token[0], end - p - length + 1);
+        if (p == nullptr) return end;
+        if (memcmp(p, token, length) == 0) return p;
+        p++;
+    }
+    return end;
+}
+
+#if IE_X86_SIMD
+// Compares each 16-byte block against the first and last token bytes at
+// once; only positions matching both are checked with memcmp
+__attribute__((target("sse2")))
+const char* findByteSse2(const char* p, const char* end, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    for (; end - p >= 16; p += 16) {
+        __m128i block = _mm_loadu_si128((const __m128i*)p);
+        int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findByteScalar(p, end, c);
+}
+
+__attribute__((target("sse2")))
+const char* findTokenSse2(const char* p, const char* end, const char* token, size_t length) {
+    __m128i first = _mm_set1_epi8(token[0]);
+    __m128i last = _mm_set1_epi8(token[length - 1]);
+    for (; end - p >= (ptrdiff_t)(16 + length - 1); p += 16) {
+        __m128i blockFirst = _mm_loadu_si128((const __m128i*)p);
+        __m128i blockLast = _mm_loadu_si128((const __m128i*)(p + length - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(blockFirst, first),
+                                                        _mm_cmpeq_epi8(blockLast, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(p + bit, token, length) == 0) return p + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findTokenScalar(p, end, token, length);
+}
+
+__attribute__((target("avx2")))
+const char* findByteAvx2(const char* p, const char* end, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    for (; end - p >= 32; p += 32) {
+        __m256i block = _mm256_loadu_si256((const __m256i*)p);
+        unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+        if (mask) return p + __builtin_ctz(mask);
+    }
+    return findByteSse2(p, end, c);
+}
+
+__attribute__((target("avx2")))
+const char* findTokenAvx2(const char* p, const char* end, const char* token, size_t length) {
+    __m256i first = _mm256_set1_epi8(token[0]);
+    __m256i last = _mm256_set1_epi8(token[length - 1]);
+    for (; end - p >= (ptrdiff_t)(32 + length - 1); p += 32) {
+        __m256i blockFirst = _mm256_loadu_si256((const __m256i*)p);
+        __m256i blockLast = _mm256_loadu_si256((const __m256i*)(p + length - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first),
+                                                              _mm256_cmpeq_epi8(blockLast, last)));
+        while (mask) {
+            int bit = __builtin_ctz(mask);
+            if (memcmp(p + bit, token, length) == 0) return p + bit;
+            mask &= mask - 1;
+        }
+    }
+    return findTokenSse2(p, end, token, length);
+}
+#endif
+
+const TextScanner TEXT_SCANNERS[] = {
+    {"scalar", findByteScalar, findTokenScalar},
+#if IE_X86_SIMD
+    {"sse2", findByteSse2, findTokenSse2},
+    {"avx2", findByteAvx2, findTokenAvx2},
+#endif
+};
+const int TEXT_SCANNER_COUNT = sizeof(TEXT_SCANNERS) / sizeof(TEXT_SCANNERS[0]);
+
+bool scannerSupported(const TextScanner& scanner) {
+#if IE_X86_SIMD
+    if (strcmp(scanner.name, "sse2") == 0) return __builtin_cpu_supports("sse2");
+    if (strcmp(scanner.name, "avx2") == 0) return __builtin_cpu_supports("avx2");
+#endif
+    return true;
+}
+
+// Widest supported implementation; later entries in TEXT_SCANNERS are wider
+const TextScanner* selectTextScanner() {
+    const TextScanner* best = &TEXT_SCANNERS[0];
+    for (int i = 1; i < TEXT_SCANNER_COUNT; i++) {
+        if (scannerSupported(TEXT_SCANNERS[i])) best = &TEXT_SCANNERS[i];
+    }
+    return best;
+}
+
+const char* scanForByte(const char* p, const char* end, char c) {
+    return textScanner->findByte(p, end, c);
+}
+
+const char* scanForToken(const char* p, const char* end, const char* token) {
+    size_t length = strlen(token);
+    if (length == 1) return textScanner->findByte(p, end, token[0]);
+    return textScanner->findToken(p, end, token, length);
+}
+
+// string::find replacement for field delimiters inside a line
+size_t findField(const string& line, const char* token, size_t from) {
+    if (from >= line.length()) return string::npos;
+    const char* end = line.data() + line.length();
+    const char* hit = scanForToken(line.data() + from, end, token);
+    return hit == end ? string::npos : hit - line.data();
+}
+
+bool startsWith(const string& line, const char* prefix) {
+    return line.compare(0, strlen(prefix), prefix) == 0;
+}
+
+bool readWholeFile(const string& filename, string& contents) {
+    ifstream file(filename, ios::binary);
+    if (!file) return false;
+    file.seekg(0, ios::end);
+    streamoff size = file.tellg();
+    file.seekg(0);
+    contents.resize(size > 0 ? (size_t)size : 0);
+    if (size > 0) file.read(&contents[0], size);
+    return (bool)file;
+}
+
+// Returns the start of the next line and sets lineEnd to the end of this
+// one, excluding any '\r' left by files written on Windows
+const char* nextLine(const char* p, const char* end, const char*& lineEnd) {
+    const char* eol = scanForByte(p, end, '\n');
+    lineEnd = eol;
+    if (lineEnd > p && lineEnd[-1] == '\r') lineEnd--;
+    return eol < end ? eol + 1 : end;
+}
+
+// getline for files that may have Windows line endings
+bool readLine(istream& in, string& line) {
+    if (!getline(in, line)) return false;
+    if (!line.empty() && line[line.length() - 1] == '\r') line.erase(line.length() - 1);
+    return true;
+}
+
+// Boundary checksum of the reference getline/string::find parse; the
+// scanners must reproduce it exactly
+unsigned long long referenceScanChecksum(const string& buffer) {
+    istringstream in(buffer);
+    string line;
+    unsigned long long checksum = 0;
+    unsigned long long lineStart = 0;
+    while (getline(in, line)) {
+        size_t atPos = line.find(" at ");
+        size_t byPos = line.find(" by ");
+        size_t colonPos = line.find(": ", byPos == string::npos ? 0 : byPos);
+        checksum = checksum * 31 + lineStart;
+        checksum = checksum * 31 + atPos;
+        checksum = checksum * 31 + byPos;
+        checksum = checksum * 31 + colonPos;
+        lineStart += line.length() + 1;
+    }
+    return checksum;
+}
+
+unsigned long long scannerChecksum(const TextScanner& scanner, const string& buffer) {
+    const char* start = buffer.data();
+    const char* end = start + buffer.size();
+    unsigned long long checksum = 0;
+    for (const char* p = start; p < end; ) {
+        const char* eol = scanner.findByte(p, end, '\n');
+        const char* at = scanner.findToken(p, eol, " at ", 4);
+        const char* by = scanner.findToken(p, eol, " by ", 4);
+        const char* colon = scanner.findToken(by == eol ? p : by, eol, ": ", 2);
+        checksum = checksum * 31 + (unsigned long long)(p - start);
+        checksum = checksum * 31 + (at == eol ? string::npos : (size_t)(at - p));
+        checksum = checksum * 31 + (by == eol ? string::npos : (size_t)(by - p));
+        checksum = checksum * 31 + (colon == eol ? string::npos : (size_t)(colon - p));
+        p = eol < end ? eol + 1 : end;
+    }
+    return checksum;
+}
+
+// --bench-scan: times the scanners against the old getline/find loop on a
+// data file (repeated to at least 16 MB) and checks they agree, including
+// on random buffers that stress block boundaries
+int runScanBenchmark(const string& filename) {
+    string sample;
+    if (!readWholeFile(filename, sample) || sample.empty()) {
+        cerr << "Cannot read " << filename << endl;
+        return 1;
+    }
+    if (sample[sample.length() - 1] != '\n') sample += '\n';
+    string buffer;
+    while (buffer.size() < 16 * 1024 * 1024) buffer += sample;
+
+    bool identical = true;
+    srand(12345);
+    const char alphabet[] = " aby:t\nx";
+    for (int round = 0; round < 2000 && identical; round++) {
+        string text(rand() % 200, ' ');
+        for (size_t i = 0; i < text.length(); i++) text[i] = alphabet[rand() % 8];
+        const char* end = text.data() + text.length();
+        for (size_t from = 0; from <= text.length(); from++) {
+            const char* p = text.data() + from;
+            for (int s = 1; s < TEXT_SCANNER_COUNT; s++) {
+                if (!scannerSupported(TEXT_SCANNERS[s])) continue;
+                if (TEXT_SCANNERS[s].findByte(p, end, ':') != findByteScalar(p, end, ':') ||
+                    TEXT_SCANNERS[s].findToken(p, end, " by ", 4) != findTokenScalar(p, end, " by ", 4) ||
+                    TEXT_SCANNERS[s].findToken(p, end, ": ", 2) != findTokenScalar(p, end, ": ", 2)) {
+                    cerr << TEXT_SCANNERS[s].name << " disagrees with scalar on random input" << endl;
+                    identical = false;
+                }
+            }
+        }
+    }
+
+    double megabytes = buffer.size() / (1024.0 * 1024.0);
+    cout << "Scan benchmark on " << filename << " (" << megabytes << " MB after repetition)" << endl;
+
+    chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+    unsigned long long expected = referenceScanChecksum(buffer);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+    cout << "  getline + string::find: " << ms << " ms (" << megabytes / (ms / 1000) << " MB/s)" << endl;
+
+    for (int s = 0; s < TEXT_SCANNER_COUNT; s++) {
+        const TextScanner& scanner = TEXT_SCANNERS[s];
+        if (!scannerSupported(scanner)) {
+            cout << "  " << scanner.name << ": not supported by this CPU" << endl;
+            continue;
+        }
+        begin = chrono::steady_clock::now();
+        unsigned long long checksum = scannerChecksum(scanner, buffer);
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - begin).count();
+        cout << "  " << scanner.name << ": " << ms << " ms (" << megabytes / (ms / 1000) << " MB/s)"
+             << (checksum == expected ? "" : "  MISMATCH") << endl;
+        if (checksum != expected) identical = false;
+    }
+
+    cout << (identical ? "All scanners produced identical boundaries." : "Scanner results differ!") << endl;
+    cout << "Loader uses: " << textScanner->name << endl;
+    return identical ? 0 : 1;
+}
+
+bool validateAdminLogin(const string& username, const string& password) {
+    string contents;
+    if (!readWholeFile("Admins.txt", contents)) {
+        cerr << "Error: Admin credentials file not found!" << endl;
+        return false;
+    }
+
+    const char* end = contents.data() + contents.size();
+    for (const char* p = contents.data(); p < end; ) {
+        const char* lineEnd;
+        const char* next = nextLine(p, end, lineEnd);
+        const char* colon = scanForByte(p, lineEnd, ':');
+        if (colon != lineEnd) {
+            if (username.compare(0, string::npos, p, colon - p) == 0 &&
+                password.compare(0, string::npos, colon + 1, lineEnd - (colon + 1)) == 0) {
+                return true;
+            }
+        }
+        p = next;
+    }
+    return false;
+}
+
+void addNewAdmin() {
+    if (currentUserIsManager) {
+        cout << "Only admins can add other admins." << endl;
+        return;
+    }
+
+    ofstream credFile("Admins.txt", ios::app);
+    if (!credFile) {
+        cerr << "Error opening credentials file!" << endl;
+        return;
+    }
+
+    string username, password;
+    cout << "Enter new admin username: ";
+    getline(cin, username);
+    cout << "Enter new admin password: ";
+    getline(cin, password);
+
+    if (validateAdminLogin(username, password)) { // Prevent duplicate admin entries
+        cout << "Admin already exists!" << endl;
+        return;
+    }
+
+    credFile << username << ":" << password << endl;
+    cout << "Admin added successfully." << endl;
+}
+
+void adminMainMenu() {
     while (true) {
-        cout << "\n=== Main Menu ===" << endl;
+        cout << "\n=== Admin Main Menu ===" << endl;
         cout << "1. Case Management" << endl;
-        if (!currentUserIsManager) {
-            cout << "2. Manager Management" << endl;
-            cout << "3. Reports" << endl;
-            cout << "4. Logout" << endl;
-        } else {
-            cout << "2. Reports" << endl;
-            cout << "3. Logout" << endl;
-        }
+        cout << "2. Manager Management" << endl;
+        cout << "3. Reports" << endl;
+        cout << "4. Add New Admin" << endl;
+        cout << "5. Logout" << endl;
         cout << "Enter your choice: ";
         
         int choice;
         cin >> choice;
         clearInputBuffer();
         
-        if (currentUserIsManager && choice >= 2) {
-            choice += 1;
-        }
-        
+        switch (choice) {
+            case 1: caseManagementMenu(); break;
+            case 2: managerManagementMenu(); break;
+            case 3: reportMenu(); break;
+            case 4: addNewAdmin(); break;
+            case 5: return;
+            default: cout << "Invalid choice!" << endl;
+        }
+    }
+}
+
+void login() {
+    while (true) {
+        cout << "=== IE System Login ===" << endl;
+        cout << "1. Login as Admin" << endl;
+        cout << "2. Login as Manager" << endl;
+        cout << "3. Exit" << endl;
+        cout << "Enter your choice: ";
+        
+        int choice;
+        cin >> choice;
+        clearInputBuffer();
+        
+        if (choice == 3) {
+            cout << "Exiting system..." << endl;
+            return; // main shuts down as after a logout
+        }
+
+        if (choice == 1) {
+            string username, password;
+            cout << "Enter admin username: ";
+            getline(cin, username);
+            cout << "Enter admin password: ";
+            getline(cin, password);
+
+            if (!validateAdminLogin(username, password)) {
+                cout << "Invalid admin credentials. Access denied." << endl;
+                continue;
+            }
+
+            currentUser = username;
+            currentUserIsManager = false;
+            cout << "Welcome, Admin " << currentUser << "!" << endl;
+            adminMainMenu();
+            return;
+        }
+        else if (choice == 2) {
+            string managerName, password;
+            cout << "Enter your name: ";
+            getline(cin, managerName);
+            
+            int managerIndex = findManagerIndex(managerName);
+            if (managerIndex == -1) {
+                cout << "Manager not found. Access denied." << endl;
+                continue;
+            }
+            
+            if (!managers[managerIndex].active) {
+                cout << "Your account is inactive. Please contact admin." << endl;
+                continue;
+            }
+
+            cout << "Enter your password: ";
+            getline(cin, password);
+            
+            if (password != managers[managerIndex].password) {
+                cout << "Invalid password. Access denied." << endl;
+                continue;
+            }
+
+            currentUser = managerName;
+            currentUserIsManager = true;
+            cout << "Welcome, Manager " << currentUser << "!" << endl;
+            mainMenu();
+            return;
+        }
+        else {
+            cout << "Invalid choice. Please try again." << endl;
+        }
+    }
+}
+
+void mainMenu() {
+    while (true) {
+        cout << "\n=== Main Menu ===" << endl;
+        cout << "1. Case Management" << endl;
+        if (!currentUserIsManager) {
+            cout << "2. Manager Management" << endl;
+            cout << "3. Reports" << endl;
+            cout << "4. Logout" << endl;
+        } else {
+            cout << "2. Reports" << endl;
+            cout << "3. Logout" << endl;
+        }
+        cout << "Enter your choice: ";
+        
+        int choice;
+        cin >> choice;
+        clearInputBuffer();
+        
+        if (currentUserIsManager && choice >= 2) {
+            choice += 1;
+        }
+        
         switch (choice) {
             case 1: caseManagementMenu(); break;
             case 2: 
@@ -326,836 +2533,5362 @@ void mainMenu() {
     }
 }
 
-void caseManagementMenu() {
-    while (true) {
-        cout << "\n=== Case Management ===" << endl;
-        cout << "1. Add New Case" << endl;
-        cout << "2. View All Cases" << endl;
-        cout << "3. View Case Details" << endl;
-        if (!currentUserIsManager) {
-            cout << "4. Assign Manager to Case" << endl;
-            cout << "5. Edit Case" << endl;
-            cout << "6. Delete Case" << endl;
-            cout << "7. Add Action to Case" << endl;
-            cout << "8. Export Case" << endl;
-            cout << "9. Close Case" << endl;
-            cout << "10. Back to Main Menu" << endl;
-        } else {
-            cout << "4. Add Action to Case" << endl;
-            cout << "5. Export Case" << endl;
-            cout << "6. Close Case" << endl;
-            cout << "7. Back to Main Menu" << endl;
+void caseManagementMenu() {
+    while (true) {
+        cout << "\n=== Case Management ===" << endl;
+        cout << "1. Add New Case" << endl;
+        cout << "2. View All Cases" << endl;
+        cout << "3. View Case Details" << endl;
+        if (!currentUserIsManager) {
+            cout << "4. Assign Manager to Case" << endl;
+            cout << "5. Edit Case" << endl;
+            cout << "6. Delete Case" << endl;
+            cout << "7. Add Action to Case" << endl;
+            cout << "8. Export Case" << endl;
+            cout << "9. Close Case" << endl;
+            cout << "10. Query Cases" << endl;
+            cout << "11. Auto-assign Open Cases" << endl;
+            cout << "12. Case History" << endl;
+            cout << "13. Back to Main Menu" << endl;
+        } else {
+            cout << "4. Add Action to Case" << endl;
+            cout << "5. Export Case" << endl;
+            cout << "6. Close Case" << endl;
+            cout << "7. Query Cases" << endl;
+            cout << "8. Back to Main Menu" << endl;
+        }
+        cout << "Enter your choice: ";
+    
+        int choice;
+        cin >> choice;
+        clearInputBuffer();
+
+        if ((!currentUserIsManager && choice == 13) || (currentUserIsManager && choice == 8)) {
+            break;
+        }
+        
+        if (currentUserIsManager) {
+            if (choice >= 4) choice += 3;
+        }
+    
+        switch (choice) {
+            case 1: addCase(); break;
+            case 2: viewCases(); break;
+            case 3: {
+                cout << "Enter Case ID: ";
+                int caseId;
+                cin >> caseId;
+                clearInputBuffer();
+                viewCaseDetails(caseId);
+                break;
+            }
+            case 4: assignManagerToCase(); break;
+            case 5: editCase(); break;
+            case 6: deleteCase(); break;
+            case 7: addActionToCase(); break;
+            case 8: exportCase(); break;
+            case 9: closeCase(); break;
+            case 10: queryCases(); break;
+            case 11: assignOpenCases(); break;
+            case 12: caseHistoryMenu(); break;
+            default: cout << "Invalid choice!" << endl;
+        }
+        autosaveCommit();
+    }
+}
+
+void managerManagementMenu() {
+    while (true) {
+        cout << "\n=== Manager Management ===" << endl;
+        cout << "1. Add New Manager" << endl;
+        cout << "2. View All Managers" << endl;
+        cout << "3. Edit Manager" << endl;
+        cout << "4. Toggle Manager Status" << endl;
+        cout << "5. Delete Manager" << endl;
+        cout << "6. Back to Main Menu" << endl;
+        cout << "Enter your choice: ";
+        
+        int choice;
+        cin >> choice;
+        clearInputBuffer();
+        
+        if (choice == 6) break;
+        
+        switch (choice) {
+            case 1: addManager(); break;
+            case 2: viewManagers(); break;
+            case 3: editManager(); break;
+            case 4: toggleManagerStatus(); break;
+            case 5: deleteManager(); break;
+            default: cout << "Invalid choice!" << endl;
+        }
+        rebuildLoadHeaps();
+        autosaveCommit();
+    }
+}
+
+void reportMenu() {
+    while (true) {
+        cout << "\n=== Reports ===" << endl;
+        cout << "1. Generate Case Report" << endl;
+        cout << "2. Generate Case Report (Including Archive)" << endl;
+        cout << "3. Search Archived Cases" << endl;
+        cout << "4. Archive Closed Cases" << endl;
+        cout << "5. Export Changes Since Sequence" << endl;
+        cout << "6. Generate SLA Report" << endl;
+        cout << "7. Custom Report (Text, JSON or CSV)" << endl;
+        cout << "8. Back to Main Menu" << endl;
+        cout << "Enter your choice: ";
+        
+        int choice;
+        cin >> choice;
+        clearInputBuffer();
+        
+        if (choice == 8) break;
+        
+        switch (choice) {
+            case 1: generateReport(ReportOptions()); break;
+            case 2: {
+                ReportOptions options;
+                options.includeArchive = true;
+                generateReport(options);
+                break;
+            }
+            case 3: searchArchive(); break;
+            case 4: {
+                if (currentUserIsManager) {
+                    cout << "Only admin can archive cases." << endl;
+                    break;
+                }
+                cout << "Archive closed cases idle for at least how many days? (Enter for " 
+                     << ARCHIVE_AFTER_DAYS << "): ";
+                string days;
+                getline(cin, days);
+                int minAge = ARCHIVE_AFTER_DAYS;
+                try {
+                    if (!days.empty()) minAge = stoi(days);
+                } catch (...) {
+                    cout << "Invalid number of days." << endl;
+                    break;
+                }
+                cout << archiveClosedCases(minAge) << " cases archived." << endl;
+                break;
+            }
+            case 5: exportChangesMenu(); break;
+            case 6: generateSlaReport(); break;
+            case 7: customReport(); break;
+            default: cout << "Invalid choice!" << endl;
+        }
+        autosaveCommit();
+    }
+}
+
+void addCase() {
+    if (cases.full()) {
+        cout << "Maximum number of cases reached!" << endl;
+        return;
+    }
+
+    string title, description, source;
+    cout << "Enter case title: ";
+    getline(cin, title);
+    cout << "Enter case description: ";
+    getline(cin, description);
+    cout << "Enter case source: ";
+    getline(cin, source);
+    DuplicateMatch match;
+    int caseId = createCase(title, description, source, match);
+    cout << "Case added successfully with ID: " << caseId << endl;
+    if (match.duplicateOf != -1) {
+        int original = findCaseIndex(match.duplicateOf);
+        cout << "Possible duplicate of case " << match.duplicateOf << " (" << (int)(100 * match.similarity + 0.5)
+             << "% similar)";
+        if (original != -1) cout << ": " << cases[original].title;
+        cout << endl;
+    }
+}
+
+// Appends a new Open case and returns its ID. match is filled in when the
+// case looks like a copy of an older open case. The store must not be full.
+int createCase(const string& title, const string& description, const string& source, DuplicateMatch& match) {
+    Case newCase;
+    newCase.id = nextCaseId++;
+    newCase.title = title;
+    newCase.description = description;
+    newCase.creationDate = getCurrentDate();
+    newCase.creationTime = getCurrentTime();
+    newCase.source = source;
+    newCase.status = "Open";
+    newCase.assignedManagerCount = 0;
+    newCase.actionCount = 0;
+    newCase.lastActionDate = PackedDate();
+    newCase.bodyLoaded = true;
+    newCase.bodyModified = true;
+    newCase.recordOffset = -1;
+    newCase.dirty = true;
+
+    {
+        lock_guard<mutex> lock(storeMutex);
+        newCase.version = storeVersion;
+        stampCase(newCase);
+        cases.append(newCase);
+    }
+    if (cases.size() > 1 && newCase.creationDate.value < cases[cases.size() - 2].creationDate.value) {
+        creationDatesOrdered = false; // Clock went backwards
+    }
+    emitChange("case.add", "\"case\":" + to_string(newCase.id) + ",\"title\":" + jsonString(newCase.title.str()) +
+               ",\"source\":" + jsonString(newCase.source.str()) + ",\"status\":\"Open\"", newCase.modifiedSeq);
+
+    CaseSignature signature;
+    match = DuplicateMatch();
+    if (signCase(newCase.id, newCase.title, description.data(), description.length(), signature)) {
+        match = findDuplicateCase(signature);
+        rememberCaseSignature(signature);
+    }
+    if (match.duplicateOf != -1) {
+        char similarity[16];
+        snprintf(similarity, sizeof(similarity), "%.2f", match.similarity);
+        emitChange("case.duplicate", "\"case\":" + to_string(newCase.id) + ",\"of\":" + to_string(match.duplicateOf) +
+                   ",\"similarity\":" + similarity);
+    }
+    return newCase.id;
+}
+
+void viewCases(bool brief) {
+    if (cases.size() == 0) {
+        cout << "No cases found." << endl;
+        return;
+    }
+
+    if (brief) {
+        printCaseHeader();
+        for (int i = 0; i < cases.size(); i++) {
+            if (!currentUserIsManager || isManagerAssignedToCase(cases[i], currentUser)) {
+                printCaseSummary(cases[i]);
+            }
+        }
+    } else {
+        // Bodies not in memory are read in one pass over the file rather than
+        // faulted in one by one: each fault scans every case for the least
+        // recently used body, and would evict the ones being worked on
+        ifstream inFile(DATA_FILE, ios::binary);
+        ifstream journal;
+        bool hasCases = false;
+        for (int i = 0; i < cases.size(); i++) {
+            const Case& c = cases[i];
+            if (currentUserIsManager && !isManagerAssignedToCase(c, currentUser)) continue;
+            if (c.bodyLoaded) {
+                printCaseDetails(c);
+            } else {
+                Case body;
+                if (readStoredCase(c, inFile, journal, body)) {
+                    printCaseDetails(c, body);
+                } else {
+                    cout << "Error reading details of case " << c.id << " from disk." << endl;
+                }
+            }
+            cout << "------------------------" << endl;
+            hasCases = true;
+        }
+        if (currentUserIsManager && !hasCases) {
+            cout << "You are not assigned to any cases." << endl;
+        }
+    }
+}
+
+bool viewCaseDetails(int caseId) {
+    int index = findCaseIndex(caseId);
+    if (index == -1) {
+        Case archivedCase;
+        if (!findArchivedCase(caseId, archivedCase)) {
+            cout << "Case not found." << endl;
+            return false;
+        }
+        if (currentUserIsManager && !isManagerAssignedToCase(archivedCase, currentUser)) {
+            cout << "Access denied. You are not assigned to this case." << endl;
+            return false;
+        }
+        printCaseDetails(archivedCase);
+        cout << "(Archived case - read only)" << endl;
+        return true;
+    }
+
+    Case& c = cases[index];
+
+    if (currentUserIsManager && !isManagerAssignedToCase(c, currentUser)) {
+        cout << "Access denied. You are not assigned to this case." << endl;
+        return false;
+    }
+
+    if (!loadCaseBody(c)) {
+        cout << "Error reading case details from disk." << endl;
+        return false;
+    }
+
+    printCaseDetails(c);
+    return true;
+}
+
+void printCaseDetails(const Case& c) {
+    printCaseDetails(c, c);
+}
+
+// Summary fields from c, description and actions from body (a record read
+// from disk for a case whose body is not loaded)
+void printCaseDetails(const Case& c, const Case& body) {
+    cout << "\n=== Case Details ===" << endl;
+    cout << "ID: " << c.id << endl;
+    cout << "Title: " << c.title << endl;
+    cout << "Description: " << body.description << endl;
+    cout << "Created: " << c.creationDate << " at " << c.creationTime << endl;
+    cout << "Source: " << c.source << endl;
+    cout << "Status: " << c.status << endl;
+
+    cout << "\nAssigned Managers (" << c.assignedManagerCount << "):" << endl;
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        cout << " - " << c.assignedManagers[i] << endl;
+    }
+
+    cout << "\nActions (" << body.actionCount << "):" << endl;
+    for (int i = 0; i < body.actionCount; i++) {
+        cout << " - " << body.actions[i].date << " " << body.actions[i].time 
+             << " by " << body.actions[i].manager << ": " 
+             << body.actions[i].description << endl;
+    }
+}
+
+void assignManagerToCase() {
+    if (currentUserIsManager) {
+        cout << "Only admin can assign managers to cases." << endl;
+        return;
+    }
+
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    Case& c = cases[caseIndex];
+    if (c.assignedManagerCount >= MAX_ASSIGNED_MANAGERS) {
+        cout << "Maximum managers already assigned to this case." << endl;
+        return;
+    }
+
+    listManagersWithLoad(c);
+
+    cout << "Enter manager name to assign (or 'auto' for the least loaded): ";
+    string managerName;
+    getline(cin, managerName);
+    if (managerName == "auto") {
+        managerName = chooseManagerAutomatically(c);
+        if (managerName.empty()) return;
+    }
+
+    int managerIndex = findManagerIndex(managerName);
+    if (managerIndex == -1 || !managers[managerIndex].active) {
+        cout << "Manager not found or inactive." << endl;
+        return;
+    }
+
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        if (c.assignedManagers[i] == managerName) {
+            cout << "Manager already assigned to this case." << endl;
+            return;
+        }
+    }
+
+    adjustCaseLoad(c, -1);
+    {
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(c);
+        c.assignedManagers[c.assignedManagerCount++] = managerName;
+        if (c.status == "Open") {
+            c.status = "Assigned";
+        }
+        c.dirty = true;
+        stampCase(c);
+    }
+    adjustCaseLoad(c, 1);
+    emitChange("case.assign", "\"case\":" + to_string(c.id) + ",\"manager\":" + jsonString(managerName) +
+               ",\"status\":" + jsonString(c.status.str()), c.modifiedSeq);
+    cout << "Manager assigned successfully." << endl;
+}
+
+// Adds a new action log entry to a specified case, only if manager is assigned
+void addActionToCase() {
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    Case& c = cases[caseIndex];
+    if (c.actionCount >= MAX_ACTIONS) {
+        cout << "Maximum actions reached for this case." << endl;
+        return;
+    }
+
+    // Ensure manager is assigned before adding action
+    if (currentUserIsManager) {
+        bool isAssigned = false;
+        for (int i = 0; i < c.assignedManagerCount; i++) {
+            if (c.assignedManagers[i] == currentUser) {
+                isAssigned = true;
+                break;
+            }
+        }
+        if (!isAssigned) {
+            cout << "You are not assigned to this case." << endl;
+            return;
+        }
+    }
+
+    if (!loadCaseBody(c)) {
+        cout << "Error reading case details from disk." << endl;
+        return;
+    }
+    // Prompt for action description
+    cout << "Enter action description: ";
+    string description;
+    getline(cin, description);
+    recordCaseAction(c, description, currentUser);
+    cout << "Action added successfully." << endl;
+}
+
+// Logs an action by manager on a case whose body is loaded and has room
+// for it, moving an Assigned case to In Progress
+void recordCaseAction(Case& c, const string& description, const string& manager) {
+    adjustCaseLoad(c, -1);
+    {
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(c);
+        Action& action = c.actions[c.actionCount++];
+        action.description = description;
+        action.date = getCurrentDate();
+        action.time = getCurrentTime();
+        action.manager = manager;
+        c.lastActionDate = action.date;
+
+        // Update status from Assigned -> In Progress if needed
+        if (c.status == "Assigned") {
+            c.status = "In Progress";
+        }
+        c.bodyModified = true;
+        c.dirty = true;
+        stampCase(c);
+    }
+    adjustCaseLoad(c, 1);
+    emitChange("case.action", "\"case\":" + to_string(c.id) + ",\"description\":" + jsonString(description) +
+               ",\"status\":" + jsonString(c.status.str()), c.modifiedSeq);
+}
+
+// Exports a case to another manager by assigning them and logging the reason as an action
+void exportCase() {
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    Case& c = cases[caseIndex];
+
+    if (c.status == "Closed") {
+        cout << "Case is already closed and cannot be exported." << endl;
+        return;
+    }
+
+    if (pickLeastLoadedManager(c, "") == -1) {
+        cout << "No available managers to export to." << endl;
+        return;
+    }
+    // Display active managers not already assigned to the case
+    listManagersWithLoad(c);
+
+    cout << "Enter manager name to export to ('auto' for the least loaded, or 'cancel' to abort): ";
+    string managerName;
+    getline(cin, managerName);
+
+    if (managerName == "cancel") {
+        cout << "Export cancelled." << endl;
+        return;
+    }
+    if (managerName == "auto") {
+        managerName = chooseManagerAutomatically(c);
+        if (managerName.empty()) return;
+    }
+
+    int managerIndex = findManagerIndex(managerName);
+    if (managerIndex == -1 || !managers[managerIndex].active) {
+        cout << "Invalid manager selection. Please choose from available managers." << endl;
+        return;
+    }
+
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        if (c.assignedManagers[i] == managerName) {
+            cout << "Case is already assigned to this manager." << endl;
+            return;
+        }
+    }
+
+    cout << "Enter reason for export: ";
+    string reason;
+    getline(cin, reason);
+    if (reason.empty()) {
+        reason = "No reason provided";
+    }
+
+    cout << "You are about to export this case to " << managerName << endl;
+    cout << "Reason: " << reason << endl;
+    cout << "Are you sure you want to proceed? (y/n): ";
+    char confirm;
+    cin >> confirm;
+    clearInputBuffer();
+
+    if (tolower(confirm) != 'y') {
+        cout << "Export cancelled." << endl;
+        return;
+    }
+
+    if (c.assignedManagerCount < MAX_ASSIGNED_MANAGERS) {
+        bool logAction = c.actionCount < MAX_ACTIONS && loadCaseBody(c);
+
+        adjustCaseLoad(c, -1);
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(c);
+
+        // Add manager to case
+        c.assignedManagers[c.assignedManagerCount++] = managerName;
+
+        // Log the export as an action
+        if (logAction) {
+            c.bodyModified = true;
+            Action& action = c.actions[c.actionCount++];
+            action.description = "Case exported to " + managerName + ". Reason: " + reason;
+            action.date = getCurrentDate();
+            action.time = getCurrentTime();
+            action.manager = currentUser;
+            c.lastActionDate = action.date;
+        }
+
+        // Update status if needed
+        c.status = "Exported";
+        c.dirty = true;
+        stampCase(c);
+        adjustCaseLoad(c, 1);
+        emitChange("case.export", "\"case\":" + to_string(c.id) + ",\"manager\":" + jsonString(managerName) +
+                   ",\"reason\":" + jsonString(reason) + ",\"status\":\"Exported\"", c.modifiedSeq);
+
+        cout << "Case successfully exported to " << managerName << endl;
+        cout << "Export details have been recorded." << endl;
+    } else {
+        cout << "Cannot export: Maximum managers already assigned to this case." << endl;
+    }
+}
+
+
+void closeCase() {
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    Case& c = cases[caseIndex];
+    if (c.status == "Closed") {
+        cout << "Case is already closed." << endl;
+        return;
+    }
+
+    adjustCaseLoad(c, -1);
+    {
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(c);
+        c.status = "Closed";
+        c.dirty = true;
+        stampCase(c);
+    }
+    forgetCaseSignature(c.id);
+    emitChange("case.close", "\"case\":" + to_string(c.id) + ",\"status\":\"Closed\"", c.modifiedSeq);
+    cout << "Case closed successfully." << endl;
+}
+
+void editCase() {
+    if (currentUserIsManager) {
+        cout << "Only admin can edit cases." << endl;
+        return;
+    }
+
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    Case& c = cases[caseIndex];
+    if (c.status == "Closed") {
+        cout << "Cannot edit closed case." << endl;
+        return;
+    }
+
+    if (!loadCaseBody(c)) {
+        cout << "Error reading case details from disk." << endl;
+        return;
+    }
+    string before[HISTORY_FIELDS] = { c.title.str(), c.description.str(), c.source.str() };
+
+    cout << "Current title: " << c.title << endl;
+    cout << "Enter new title (or press Enter to keep current): ";
+    string newTitle;
+    getline(cin, newTitle);
+
+    cout << "Current description: " << c.description << endl;
+    cout << "Enter new description (or press Enter to keep current): ";
+    string newDesc;
+    getline(cin, newDesc);
+
+    cout << "Current source: " << c.source << endl;
+    cout << "Enter new source (or press Enter to keep current): ";
+    string newSource;
+    getline(cin, newSource);
+
+    {
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(c);
+        if (!newTitle.empty()) {
+            c.title = newTitle;
+        }
+        if (!newDesc.empty()) {
+            c.description = newDesc;
+        }
+        if (!newSource.empty()) {
+            c.source = newSource;
+        }
+        c.bodyModified = true;
+        c.dirty = true;
+        stampCase(c);
+    }
+    recordCaseEdit(c, before);
+    CaseSignature signature;
+    if (signCase(c.id, c.title, c.description.chars, c.description.length(), signature)) {
+        rememberCaseSignature(signature);
+    } else {
+        forgetCaseSignature(c.id);
+    }
+    string changed;
+    if (!newTitle.empty()) changed += ",\"title\":" + jsonString(newTitle);
+    if (!newDesc.empty()) changed += ",\"description\":" + jsonString(newDesc);
+    if (!newSource.empty()) changed += ",\"source\":" + jsonString(newSource);
+    emitChange("case.edit", "\"case\":" + to_string(c.id) + changed, c.modifiedSeq);
+
+    cout << "Case updated successfully." << endl;
+}
+
+void deleteCase() {
+    if (currentUserIsManager) {
+        cout << "Only admin can delete cases." << endl;
+        return;
+    }
+
+    cout << "Enter Case ID to delete: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex == -1) {
+        cout << "Case not found." << endl;
+        return;
+    }
+
+    markCaseDeleted(caseId);
+    adjustCaseLoad(cases[caseIndex], -1);
+    {
+        lock_guard<mutex> lock(storeMutex);
+        prepareCaseWrite(cases[caseIndex]);
+        cases.erase(caseIndex);
+    }
+    forgetCaseSignature(caseId);
+    emitChange("case.delete", "\"case\":" + to_string(caseId), addTombstone(caseId, ""));
+
+    cout << "Case deleted successfully." << endl;
+}
+
+// Workload-aware assignment. managerLoad[] holds each manager's weighted
+// count of unclosed cases; loadHeaps keep the active managers ordered by it
+// so the least loaded one is found, and a change applied, in O(log managers).
+int caseLoadWeight(const Case& c) {
+    if (c.status == "Closed") return 0;
+    if (c.status == "In Progress" || c.status == "Exported") return LOAD_WEIGHT_WORKED;
+    return LOAD_WEIGHT_NEW;
+}
+
+bool lessLoaded(int a, int b) {
+    if (managerLoad[a] != managerLoad[b]) return managerLoad[a] < managerLoad[b];
+    return a < b;
+}
+
+void swapLoadHeapItems(LoadHeap& heap, int i, int j) {
+    swap(heap.items[i], heap.items[j]);
+    heap.position[heap.items[i]] = i;
+    heap.position[heap.items[j]] = j;
+}
+
+// Restores heap order around a manager whose load changed
+void siftLoadHeap(LoadHeap& heap, int manager) {
+    int i = heap.position[manager];
+    if (i < 0) return;
+    while (i > 0 && lessLoaded(heap.items[i], heap.items[(i - 1) / 2])) {
+        swapLoadHeapItems(heap, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+    while (true) {
+        int smallest = i;
+        int left = 2 * i + 1, right = 2 * i + 2;
+        if (left < heap.count && lessLoaded(heap.items[left], heap.items[smallest])) smallest = left;
+        if (right < heap.count && lessLoaded(heap.items[right], heap.items[smallest])) smallest = right;
+        if (smallest == i) break;
+        swapLoadHeapItems(heap, i, smallest);
+        i = smallest;
+    }
+}
+
+void pushLoadHeap(LoadHeap& heap, int manager) {
+    heap.items[heap.count] = manager;
+    heap.position[manager] = heap.count++;
+    siftLoadHeap(heap, manager);
+}
+
+int managerOfSymbolId(unsigned int id) {
+    return id < managerOfSymbolSize ? managerOfSymbol[id] : -1;
+}
+
+// Recomputes loads from the case store. Called after loading and whenever
+// managers are added, removed, reactivated or move department.
+void rebuildLoadHeaps() {
+    for (int i = 0; i < managers.size(); i++) Symbol(managers[i].name); // Intern before sizing
+    {
+        lock_guard<mutex> lock(symbolMutex);
+        if (managerOfSymbolSize < symbolCount) {
+            delete[] managerOfSymbol;
+            managerOfSymbolSize = symbolSlotCount; // Room to grow before the next resize
+            managerOfSymbol = new short[managerOfSymbolSize];
+        }
+    }
+    for (unsigned int i = 0; i < managerOfSymbolSize; i++) managerOfSymbol[i] = -1;
+    for (int i = 0; i < managers.size(); i++) {
+        managerLoad[i] = 0;
+        managerOfSymbol[Symbol(managers[i].name).id] = i;
+    }
+    for (int i = 0; i < cases.size(); i++) {
+        int weight = caseLoadWeight(cases[i]);
+        for (int j = 0; j < cases[i].assignedManagerCount; j++) {
+            int manager = managerOfSymbolId(cases[i].assignedManagers[j].id);
+            if (manager >= 0) managerLoad[manager] += weight;
+        }
+    }
+
+    loadHeapCount = 1;
+    loadHeaps[0].department = Symbol();
+    loadHeaps[0].count = 0;
+    for (int i = 0; i < managers.size(); i++) {
+        loadHeaps[0].position[i] = -1;
+        managerDepartmentHeap[i] = -1;
+    }
+    for (int i = 0; i < managers.size(); i++) {
+        if (!managers[i].active) continue;
+        int h = 1;
+        while (h < loadHeapCount && !(loadHeaps[h].department == managers[i].department)) h++;
+        if (h == loadHeapCount) {
+            loadHeaps[h].department = managers[i].department;
+            loadHeaps[h].count = 0;
+            for (int j = 0; j < managers.size(); j++) loadHeaps[h].position[j] = -1;
+            loadHeapCount++;
+        }
+        managerDepartmentHeap[i] = h;
+        pushLoadHeap(loadHeaps[0], i);
+        pushLoadHeap(loadHeaps[h], i);
+    }
+}
+
+// Adds (sign 1) or removes (sign -1) a case's weight from its managers.
+// Mutations call it with -1 before changing status or assignments and
+// with 1 afterwards.
+void adjustCaseLoad(const Case& c, int sign) {
+    int weight = caseLoadWeight(c);
+    if (weight == 0) return;
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        int manager = managerOfSymbolId(c.assignedManagers[i].id);
+        if (manager < 0) continue;
+        managerLoad[manager] += sign * weight;
+        siftLoadHeap(loadHeaps[0], manager);
+        if (managerDepartmentHeap[manager] > 0) {
+            siftLoadHeap(loadHeaps[managerDepartmentHeap[manager]], manager);
+        }
+    }
+}
+
+// Least loaded active manager, optionally within one department, who is not
+// already on case c; -1 if there is none. Walks the heap best-first, so it
+// only looks past the root for the few managers already assigned.
+int pickLeastLoadedManager(const Case& c, const string& department) {
+    const LoadHeap* heap = &loadHeaps[0];
+    if (!department.empty()) {
+        heap = nullptr;
+        for (int h = 1; h < loadHeapCount; h++) {
+            if (loadHeaps[h].department == department) heap = &loadHeaps[h];
+        }
+        if (heap == nullptr) return -1;
+    }
+
+    int frontier[MAX_MANAGERS];
+    int frontierCount = 0;
+    if (heap->count > 0) frontier[frontierCount++] = 0;
+    while (frontierCount > 0) {
+        int best = 0;
+        for (int i = 1; i < frontierCount; i++) {
+            if (lessLoaded(heap->items[frontier[i]], heap->items[frontier[best]])) best = i;
+        }
+        int slot = frontier[best];
+        frontier[best] = frontier[--frontierCount];
+        int manager = heap->items[slot];
+        if (!isManagerAssignedToCase(c, managers[manager].name)) return manager;
+        if (2 * slot + 1 < heap->count) frontier[frontierCount++] = 2 * slot + 1;
+        if (2 * slot + 2 < heap->count) frontier[frontierCount++] = 2 * slot + 2;
+    }
+    return -1;
+}
+
+// Asks which department to pick from and returns the chosen manager's
+// name, or "" when no one is available
+string chooseManagerAutomatically(const Case& c) {
+    cout << "Department (or press Enter for any): ";
+    string department;
+    getline(cin, department);
+    int manager = pickLeastLoadedManager(c, department);
+    if (manager == -1) {
+        cout << "No available manager" << (department.empty() ? "" : " in " + department) << "." << endl;
+        return "";
+    }
+    cout << "Least loaded manager: " << managers[manager].name << " (load " << managerLoad[manager] << ")" << endl;
+    return managers[manager].name;
+}
+
+void listManagersWithLoad(const Case& c) {
+    cout << "Available Managers:" << endl;
+    for (int i = 0; i < managers.size(); i++) {
+        if (managers[i].active && !isManagerAssignedToCase(c, managers[i].name)) {
+            cout << " - " << managers[i].name << " (" << managers[i].department << ", load "
+                 << managerLoad[i] << ")" << endl;
+        }
+    }
+}
+
+// Assigns every unassigned Open case to the least loaded manager at that
+// moment, so a backlog is spread evenly in one pass
+void assignOpenCases() {
+    if (currentUserIsManager) {
+        cout << "Only admin can assign managers to cases." << endl;
+        return;
+    }
+    cout << "Department (or press Enter for any): ";
+    string department;
+    getline(cin, department);
+
+    int assigned = 0;
+    for (int i = 0; i < cases.size(); i++) {
+        Case& c = cases[i];
+        if (!(c.status == "Open") || c.assignedManagerCount > 0) continue;
+        int manager = pickLeastLoadedManager(c, department);
+        if (manager == -1) {
+            cout << "No available manager" << (department.empty() ? "" : " in " + department) << "." << endl;
+            break;
+        }
+        {
+            lock_guard<mutex> lock(storeMutex);
+            prepareCaseWrite(c);
+            c.assignedManagers[c.assignedManagerCount++] = managers[manager].name;
+            c.status = "Assigned";
+            c.dirty = true;
+            stampCase(c);
+        }
+        adjustCaseLoad(c, 1);
+        emitChange("case.assign", "\"case\":" + to_string(c.id) + ",\"manager\":" + jsonString(managers[manager].name) +
+                   ",\"status\":\"Assigned\",\"auto\":true", c.modifiedSeq);
+        cout << "Case " << c.id << " -> " << managers[manager].name << endl;
+        assigned++;
+    }
+    cout << assigned << " open cases assigned." << endl;
+}
+
+void addManager() {
+    if (managers.full()) {
+        cout << "Maximum number of managers reached." << endl;
+        return;
+    }
+
+    Manager added;
+    cout << "Enter manager name: ";
+    getline(cin, added.name);
+    cout << "Enter department: ";
+    string department;
+    getline(cin, department);
+    added.department = department;
+    cout << "Set password: ";
+    getline(cin, added.password);
+    added.active = true;
+    added.dirty = true;
+    Manager& m = managers.append(added);
+    emitChange("manager.add", "\"manager\":" + jsonString(m.name) + ",\"department\":" + jsonString(department) +
+               ",\"active\":true", stampManager(m));
+
+    cout << "Manager added successfully." << endl;
+}
+
+void viewManagers() {
+    if (managers.size() == 0) {
+        cout << "No managers found." << endl;
+        return;
+    }
+
+    cout << "\n=== Manager List ===" << endl;
+    for (int i = 0; i < managers.size(); i++) {
+        cout << "Name: " << managers[i].name << endl;
+        cout << "Department: " << managers[i].department << endl;
+        cout << "Status: " << (managers[i].active ? "Active" : "Inactive") << endl;
+        cout << "---------------------" << endl;
+    }
+}
+
+void editManager() {
+    cout << "Enter manager name to edit: ";
+    string name;
+    getline(cin, name);
+
+    int index = findManagerIndex(name);
+    if (index == -1) {
+        cout << "Manager not found." << endl;
+        return;
+    }
+
+    Manager& m = managers[index];
+    cout << "Current department: " << m.department << endl;
+    cout << "Enter new department (or press Enter to keep current): ";
+    string newDept;
+    getline(cin, newDept);
+    if (!newDept.empty()) {
+        m.department = newDept;
+        m.dirty = true;
+        emitChange("manager.edit", "\"manager\":" + jsonString(m.name) + ",\"department\":" + jsonString(newDept),
+                   stampManager(m));
+    }
+
+    cout << "Manager updated successfully." << endl;
+}
+
+void toggleManagerStatus() {
+    cout << "Enter manager name to toggle status: ";
+    string name;
+    getline(cin, name);
+
+    int index = findManagerIndex(name);
+    if (index == -1) {
+        cout << "Manager not found." << endl;
+        return;
+    }
+
+    managers[index].active = !managers[index].active;
+    managers[index].dirty = true;
+    emitChange("manager.status", "\"manager\":" + jsonString(managers[index].name) + ",\"active\":" +
+               (managers[index].active ? "true" : "false"), stampManager(managers[index]));
+    cout << "Manager status updated to: " << (managers[index].active ? "Active" : "Inactive") << endl;
+}
+
+void deleteManager() {
+    if (currentUserIsManager) {
+        cout << "Only admin can delete managers." << endl;
+        return;
+    }
+
+    if (managers.size() <= 0) {
+        cout << "No managers to delete." << endl;
+        return;
+    }
+
+    cout << "Enter manager name to delete: ";
+    string name;
+    getline(cin, name);
+
+    int index = findManagerIndex(name);
+    if (index == -1) {
+        cout << "Manager not found." << endl;
+        return;
+    }
+
+    for (int i = 0; i < cases.size(); i++) {
+        for (int j = 0; j < cases[i].assignedManagerCount; j++) {
+            if (cases[i].assignedManagers[j] == name) {
+                cout << "Cannot delete manager. They are assigned to case ID: " 
+                     << cases[i].id << endl;
+                return;
+            }
+        }
+    }
+
+    markManagerDeleted(name);
+    managers.erase(index);
+    emitChange("manager.delete", "\"manager\":" + jsonString(name), addTombstone(-1, name));
+
+    cout << "Manager deleted successfully." << endl;
+}
+
+// Reports run on a background thread against a snapshot, so editing can
+// continue while they are written
+void generateReport(const ReportOptions& options) {
+    if (reportThread.joinable()) reportThread.join(); // One report at a time
+    CaseSnapshot* snap = takeSnapshot();
+    if (snap == nullptr) {
+        cout << "Too many background tasks running. Please try again shortly." << endl;
+        return;
+    }
+    if (options.target == "-") {
+        runReport(snap, options); // The screen is shared with the menus
+        return;
+    }
+    reportThread = thread(runReport, snap, options);
+    cout << "Generating report in the background..." << endl;
+}
+
+// Prompts for format, fields and destination, then generates the report
+void customReport() {
+    ReportOptions options;
+    string error;
+    cout << "Format (text/json/csv, Enter for text): ";
+    string format;
+    getline(cin, format);
+    cout << "Fields, comma separated (Enter for " << DEFAULT_REPORT_FIELDS << ")" << endl;
+    cout << "  available: id,title,description,status,source,created,managers,actions,last_action,modified,action_log: ";
+    string fields;
+    getline(cin, fields);
+    if (!parseReportOptions(format, fields, options, error)) {
+        cout << error << endl;
+        return;
+    }
+    cout << "Include archived cases? (y/n): ";
+    string archive;
+    getline(cin, archive);
+    options.includeArchive = archive == "y" || archive == "Y";
+    cout << "Output file (Enter for a new dated file, - for the screen): ";
+    getline(cin, options.target);
+    generateReport(options);
+}
+
+// Fills format and fields; an empty string keeps the default
+bool parseReportOptions(const string& format, const string& fields, ReportOptions& options, string& error) {
+    if (format.empty() || format == "text") {
+        options.format = REPORT_TEXT;
+    } else if (format == "json") {
+        options.format = REPORT_JSON;
+    } else if (format == "csv") {
+        options.format = REPORT_CSV;
+    } else {
+        error = "Unknown report format: " + format;
+        return false;
+    }
+
+    string list = fields.empty() ? DEFAULT_REPORT_FIELDS : fields;
+    options.fieldCount = 0;
+    options.needsBody = false;
+    size_t start = 0;
+    while (start <= list.length()) {
+        size_t comma = list.find(',', start);
+        if (comma == string::npos) comma = list.length();
+        string name = list.substr(start, comma - start);
+        start = comma + 1;
+        if (name.empty()) continue;
+        int field = 0;
+        while (field < REPORT_FIELD_COUNT && name != REPORT_FIELD_NAMES[field]) field++;
+        if (field == REPORT_FIELD_COUNT) {
+            error = "Unknown report field: " + name;
+            return false;
+        }
+        if (options.fieldCount == REPORT_FIELD_COUNT) break;
+        options.fields[options.fieldCount++] = (ReportField)field;
+        if (field == REPORT_DESCRIPTION || field == REPORT_ACTION_LOG) options.needsBody = true;
+    }
+    if (options.fieldCount == 0) {
+        error = "No report fields given.";
+        return false;
+    }
+    return true;
+}
+
+// case_report_YYYY-MM-DD.<ext>, or _2, _3, ... if reports already exist
+string uniqueReportName(const string& extension) {
+    string stem = "case_report_" + getCurrentDate();
+    string name = stem + extension;
+    for (int n = 2; ifstream(name).good(); n++) {
+        name = stem + "_" + to_string(n) + extension;
+    }
+    return name;
+}
+
+// False if the report could not be written in full. When it goes to
+// stdout, messages go to stderr so that they stay out of the report.
+bool runReport(CaseSnapshot* snap, ReportOptions options) {
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+    // Archived cases are counted from the index without opening segments
+    int archivedCount = 0;
+    ifstream index;
+    if (options.includeArchive) {
+        index.open(ARCHIVE_INDEX_FILE);
+        string line;
+        ArchiveEntry entry;
+        while (getline(index, line)) {
+            if (parseArchiveEntry(line, entry)) archivedCount++;
+        }
+        index.clear();
+        index.seekg(0);
+    }
+
+    if (snap->caseCount == 0 && archivedCount == 0) {
+        releaseSnapshot(snap);
+        (options.target == "-" ? cerr : cout) << "No cases to report." << endl;
+        return true;
+    }
+
+    static const char* const EXTENSIONS[] = { ".txt", ".jsonl", ".csv" };
+    string filename = options.target;
+    if (filename.empty()) filename = uniqueReportName(EXTENSIONS[options.format]);
+    ofstream file;
+    if (filename != "-") {
+        file.open(filename, ios::binary);
+        if (!file) {
+            releaseSnapshot(snap);
+            cerr << "Error creating report file " << filename << endl;
+            return false;
+        }
+    }
+    ostream& report = filename == "-" ? cout : file;
+
+    // Records are formatted into one large buffer that is written out in
+    // big blocks, whatever the format
+    string buffer;
+    buffer.reserve(REPORT_BUFFER_SIZE + 4096);
+    long long bytes = 0;
+    if (options.format == REPORT_TEXT) {
+        buffer += "=== Case Management System Report ===\n";
+        buffer += "Generated on: " + getCurrentDate() + " at " + getCurrentTime() + "\n";
+        buffer += "Total cases: " + to_string(snap->caseCount + archivedCount) + "\n";
+        if (options.includeArchive) {
+            buffer += "Archived cases: " + to_string(archivedCount) + "\n";
+        }
+        buffer += "\n";
+    } else if (options.format == REPORT_CSV) {
+        for (int f = 0; f < options.fieldCount; f++) {
+            if (f > 0) buffer += ',';
+            buffer += REPORT_FIELD_NAMES[options.fields[f]];
+        }
+        buffer += "\n";
+    }
+
+    ifstream dataFile;
+    if (options.needsBody) dataFile.open(DATA_FILE, ios::binary);
+    ifstream journal;
+    Case c;
+    Case record;
+    int reported = 0;
+    int unreadable = 0;
+    int lastId = numeric_limits<int>::min();
+    while (snapshotNextCase(snap, lastId, c)) {
+        lastId = c.id;
+        const Case* body = &c;
+        if (options.needsBody && !c.bodyLoaded) {
+            if (!readStoredCase(c, dataFile, journal, record)) {
+                cerr << "Error reading case " << c.id << " from disk." << endl;
+                unreadable++;
+                continue;
+            }
+            body = &record;
+        }
+        writeReportEntry(buffer, c, *body, options);
+        reported++;
+        if (buffer.size() >= REPORT_BUFFER_SIZE) {
+            report.write(buffer.data(), buffer.size());
+            bytes += buffer.size();
+            buffer.clear();
+        }
+    }
+    releaseSnapshot(snap);
+
+    if (options.includeArchive) {
+        string line;
+        ArchiveEntry entry;
+        string openSegment;
+        ifstream segment;
+        while (getline(index, line)) {
+            if (!parseArchiveEntry(line, entry)) continue;
+            if (entry.segment != openSegment) {
+                segment.close();
+                segment.clear();
+                segment.open(entry.segment);
+                openSegment = entry.segment;
+            }
+            Case archivedCase;
+            if (!segment || !readCaseRecord(segment, entry.offset, archivedCase)) {
+                cerr << "Error reading archived case " << entry.id << " from " << entry.segment << endl;
+                unreadable++;
+                continue;
+            }
+            writeReportEntry(buffer, archivedCase, archivedCase, options);
+            reported++;
+            if (buffer.size() >= REPORT_BUFFER_SIZE) {
+                report.write(buffer.data(), buffer.size());
+                bytes += buffer.size();
+                buffer.clear();
+            }
+        }
+    }
+
+    report.write(buffer.data(), buffer.size());
+    bytes += buffer.size();
+    report.flush();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    if (filename == "-") {
+        if (!report) {
+            cerr << "Error writing the report to standard output" << endl;
+            return false;
+        }
+        cerr << reported << " cases, " << bytes << " bytes in " << ms << " ms" << endl;
+    } else {
+        file.close();
+        if (!file) {
+            cerr << "Error writing report file " << filename << endl;
+            return false;
+        }
+        cout << "Report generated: " << filename << endl;
+    }
+    if (unreadable > 0) cerr << unreadable << " cases could not be read and are missing from the report" << endl;
+    return unreadable == 0;
+}
+
+// Escapes for a CSV field, quoting only when needed
+void appendCsv(string& out, const string& text) {
+    bool plain = true;
+    for (size_t i = 0; i < text.length() && plain; i++) {
+        char ch = text[i];
+        plain = ch != ',' && ch != '"' && ch != '\n' && ch != '\r';
+    }
+    if (plain) {
+        out += text;
+        return;
+    }
+    out += '"';
+    for (size_t i = 0; i < text.length(); i++) {
+        if (text[i] == '"') out += '"';
+        out += text[i];
+    }
+    out += '"';
+}
+
+// Appends date, then separator and time unless separator is 0
+void appendTimestamp(string& out, const PackedDate& date, char separator, const PackedTime& time) {
+    char buffer[10];
+    out.append(buffer, date.format(buffer));
+    if (separator == 0) return;
+    out += separator;
+    out.append(buffer, time.format(buffer));
+}
+
+void appendText(string& out, const Text& text) {
+    if (!text.empty()) out.append(text.chars, text.size);
+}
+
+// Appends one case in the chosen format; body supplies the description and
+// actions, which may come from a disk copy. Values are built in place, with
+// no string per field, so every format writes at the speed of the text one.
+void writeReportEntry(string& out, const Case& c, const Case& body, const ReportOptions& options) {
+    string value;
+    for (int f = 0; f < options.fieldCount; f++) {
+        ReportField field = options.fields[f];
+        if (options.format == REPORT_JSON) {
+            out += f == 0 ? "{\"" : ",\"";
+            out += REPORT_FIELD_NAMES[field];
+            out += "\":";
+        } else if (options.format == REPORT_CSV && f > 0) {
+            out += ',';
+        }
+
+        value.clear();
+        bool number = false;
+        switch (field) {
+            case REPORT_ID: value += to_string(c.id); number = true; break;
+            case REPORT_TITLE: appendText(value, c.title); break;
+            case REPORT_DESCRIPTION: appendText(value, body.description); break;
+            case REPORT_STATUS: value += c.status.str(); break;
+            case REPORT_SOURCE: value += c.source.str(); break;
+            case REPORT_CREATED:
+                appendTimestamp(value, c.creationDate, options.format == REPORT_TEXT ? 0 : 'T', c.creationTime);
+                break;
+            case REPORT_ACTIONS: value += to_string(c.actionCount); number = true; break;
+            case REPORT_LAST_ACTION: appendTimestamp(value, c.lastActionDate, 0, PackedTime()); break;
+            case REPORT_MODIFIED:
+                if (c.modifiedSeq > 0) appendTimestamp(value, c.modifiedDate, 'T', c.modifiedTime);
+                break;
+            case REPORT_MANAGERS:
+                if (options.format == REPORT_JSON) {
+                    out += '[';
+                    for (int j = 0; j < c.assignedManagerCount; j++) {
+                        if (j > 0) out += ',';
+                        const string& name = c.assignedManagers[j].str();
+                        appendJson(out, name.data(), name.length());
+                    }
+                    out += ']';
+                    continue;
+                }
+                for (int j = 0; j < c.assignedManagerCount; j++) {
+                    if (j > 0) value += options.format == REPORT_TEXT ? ", " : ";";
+                    value += c.assignedManagers[j].str();
+                }
+                break;
+            case REPORT_ACTION_LOG:
+                if (options.format == REPORT_JSON) {
+                    out += '[';
+                    for (int j = 0; j < body.actionCount; j++) {
+                        const Action& a = body.actions[j];
+                        out += j > 0 ? ",{\"time\":\"" : "{\"time\":\"";
+                        appendTimestamp(out, a.date, 'T', a.time);
+                        out += "\",\"manager\":";
+                        const string& manager = a.manager.str();
+                        appendJson(out, manager.data(), manager.length());
+                        out += ",\"description\":";
+                        appendJson(out, a.description.chars, a.description.size);
+                        out += '}';
+                    }
+                    out += ']';
+                    continue;
+                }
+                for (int j = 0; j < body.actionCount; j++) {
+                    const Action& a = body.actions[j];
+                    if (options.format == REPORT_TEXT) value += "\n  - "; else if (j > 0) value += " | ";
+                    appendTimestamp(value, a.date, ' ', a.time);
+                    value += " by ";
+                    value += a.manager.str();
+                    value += ": ";
+                    appendText(value, a.description);
+                }
+                break;
+            default: break;
+        }
+
+        if (options.format == REPORT_JSON) {
+            if (number) out += value; else appendJson(out, value.data(), value.length());
+        } else if (options.format == REPORT_CSV) {
+            appendCsv(out, value);
+        } else {
+            static const char* const TEXT_LABELS[REPORT_FIELD_COUNT] = {
+                "Case ID", "Title", "Description", "Status", "Source", "Created", "Assigned Managers",
+                "Action Count", "Last Action", "Modified", "Actions"
+            };
+            out += TEXT_LABELS[field];
+            out += ": ";
+            out += value;
+            out += '\n';
+        }
+    }
+    if (options.format == REPORT_JSON) {
+        out += "}\n";
+    } else if (options.format == REPORT_CSV) {
+        out += '\n';
+    } else {
+        out += "------------------------\n";
+    }
+}
+
+// --report <text|json|csv> [fields] [file]: writes to stdout unless a
+// file is given; load messages go to stderr so stdout is just the report.
+// Exits 1 if the report could not be written in full.
+int runBatchReport(const string& format, const string& fields, const string& target, bool includeArchive) {
+    ReportOptions options;
+    string error;
+    if (!parseReportOptions(format, fields, options, error)) {
+        cerr << error << endl;
+        return 2;
+    }
+    options.includeArchive = includeArchive;
+    options.target = target.empty() ? "-" : target;
+    streambuf* output = cout.rdbuf(cerr.rdbuf());
+    loadData();
+    cout.rdbuf(output);
+    CaseSnapshot* snap = takeSnapshot();
+    return runReport(snap, options) ? 0 : 1;
+}
+
+// SLA and aging metrics. Durations go into log-scale histograms with fixed
+// bucket boundaries, so each worker thread fills its own table over a slice
+// of the case IDs and the tables are merged by adding counts.
+int durationBucket(long long seconds) {
+    if (seconds < SLA_SUB_BUCKETS) return seconds < 0 ? 0 : (int)seconds;
+    int octave = 63 - __builtin_clzll((unsigned long long)seconds);
+    int sub = (int)(seconds >> (octave - 3)) & (SLA_SUB_BUCKETS - 1);
+    return min((octave - 2) * SLA_SUB_BUCKETS + sub, SLA_BUCKETS - 1);
+}
+
+// Largest duration that falls in a bucket
+long long bucketUpperBound(int bucket) {
+    if (bucket < SLA_SUB_BUCKETS) return bucket;
+    int octave = bucket / SLA_SUB_BUCKETS + 2;
+    int sub = bucket % SLA_SUB_BUCKETS;
+    return ((long long)(SLA_SUB_BUCKETS + sub + 1) << (octave - 3)) - 1;
+}
+
+void recordDuration(DurationHistogram& h, long long seconds) {
+    if (seconds < 0) seconds = 0; // Clock adjustments
+    h.counts[durationBucket(seconds)]++;
+    h.total++;
+    h.sum += seconds;
+    if (seconds > h.maxValue) h.maxValue = seconds;
+}
+
+void mergeHistogram(DurationHistogram& into, const DurationHistogram& from) {
+    for (int i = 0; i < SLA_BUCKETS; i++) into.counts[i] += from.counts[i];
+    into.total += from.total;
+    into.sum += from.sum;
+    into.maxValue = max(into.maxValue, from.maxValue);
+}
+
+long long histogramPercentile(const DurationHistogram& h, double fraction) {
+    long long rank = (long long)(fraction * h.total + 0.5);
+    if (rank < 1) rank = 1;
+    long long seen = 0;
+    for (int i = 0; i < SLA_BUCKETS; i++) {
+        seen += h.counts[i];
+        if (seen >= rank) return min(bucketUpperBound(i), h.maxValue);
+    }
+    return h.maxValue;
+}
+
+string formatDuration(long long seconds) {
+    char text[32];
+    if (seconds >= 86400) {
+        snprintf(text, sizeof(text), "%lldd %lldh", seconds / 86400, seconds % 86400 / 3600);
+    } else if (seconds >= 3600) {
+        snprintf(text, sizeof(text), "%lldh %lldm", seconds / 3600, seconds % 3600 / 60);
+    } else if (seconds >= 60) {
+        snprintf(text, sizeof(text), "%lldm %llds", seconds / 60, seconds % 60);
+    } else {
+        snprintf(text, sizeof(text), "%llds", seconds);
+    }
+    return text;
+}
+
+// Slot for (dimension, key) in a worker's table, or -1 when it is full
+int slaGroupSlot(SlaTable& table, SlaDimension dimension, Symbol key) {
+    for (int i = 0; i < table.groupCount; i++) {
+        if (table.groups[i].dimension == dimension && table.groups[i].key == key) return i;
+    }
+    if (table.groupCount == MAX_SLA_GROUPS) {
+        table.droppedGroups++;
+        return -1;
+    }
+    SlaGroup& group = table.groups[table.groupCount];
+    group.dimension = dimension;
+    group.key = key;
+    return table.groupCount++;
+}
+
+long long secondsOf(PackedDate date, PackedTime time) {
+    return (long long)dayNumber(date) * 86400 + (time.empty() ? 0 : time.value);
+}
+
+// Adds one case's durations to every group it belongs to. Status changes
+// are not logged, so the entry into the current status is inferred: an
+// action moves a case to In Progress or Exported, and assigning or closing
+// it is its last modification.
+void recordCaseMetrics(SlaTable& table, const Case& c, const Case& body, const CaseSnapshot* snap, long long now) {
+    long long created = secondsOf(c.creationDate, c.creationTime);
+    long long modified = c.modifiedDate.empty() ? -1 : secondsOf(c.modifiedDate, c.modifiedTime);
+    long long lastAction = -1;
+    if (body.actionCount > 0) {
+        const Action& last = body.actions[body.actionCount - 1];
+        lastAction = secondsOf(last.date, last.time);
+    }
+
+    long long durations[SLA_METRICS];
+    for (int m = 0; m < SLA_METRICS; m++) durations[m] = -1;
+    if (body.actionCount > 0) {
+        durations[SLA_FIRST_ACTION] = secondsOf(body.actions[0].date, body.actions[0].time) - created;
+    }
+    if (c.status == "Closed") {
+        long long closed = max(modified, lastAction); // Stamps loaded from old files predate the close
+        if (closed >= 0) durations[SLA_TO_CLOSE] = closed - created;
+    } else if (c.status == "Open") {
+        durations[SLA_AGE_OPEN] = now - created;
+    } else if (c.status == "Assigned") {
+        durations[SLA_AGE_ASSIGNED] = now - (modified >= 0 ? modified : created);
+    } else if (c.status == "In Progress") {
+        durations[SLA_AGE_IN_PROGRESS] = now - (lastAction >= 0 ? lastAction : created);
+    } else if (c.status == "Exported") {
+        durations[SLA_AGE_EXPORTED] = now - (lastAction >= 0 ? lastAction : created);
+    }
+
+    int slots[2 + 2 * MAX_ASSIGNED_MANAGERS];
+    int slotCount = 0;
+    slots[slotCount++] = slaGroupSlot(table, SLA_ALL, Symbol());
+    slots[slotCount++] = slaGroupSlot(table, SLA_SOURCE, c.source);
+    Symbol departments[MAX_ASSIGNED_MANAGERS];
+    int departmentCount = 0;
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        slots[slotCount++] = slaGroupSlot(table, SLA_MANAGER, c.assignedManagers[i]);
+        for (int j = 0; j < snap->managerCount; j++) {
+            if (!(c.assignedManagers[i] == snap->managers[j].name)) continue;
+            Symbol department = snap->managers[j].department;
+            bool seen = false;
+            for (int k = 0; k < departmentCount; k++) seen = seen || departments[k] == department;
+            if (!seen) {
+                departments[departmentCount++] = department;
+                slots[slotCount++] = slaGroupSlot(table, SLA_DEPARTMENT, department);
+            }
+            break;
+        }
+    }
+
+    for (int s = 0; s < slotCount; s++) {
+        if (slots[s] < 0) continue;
+        for (int m = 0; m < SLA_METRICS; m++) {
+            if (durations[m] >= 0) recordDuration(table.groups[slots[s]].metrics[m], durations[m]);
+        }
+    }
+    table.casesSeen++;
+}
+
+// Worker: every case with afterId < id <= lastId as of the snapshot
+void collectSlaMetrics(CaseSnapshot* snap, int afterId, int lastId, long long now, SlaTable* table) {
+    ifstream dataFile(DATA_FILE, ios::binary);
+    ifstream journal;
+    Case c;
+    Case record;
+    while (snapshotNextCase(snap, afterId, c) && c.id <= lastId) {
+        afterId = c.id;
+        const Case* body = &c;
+        if (!c.bodyLoaded) {
+            if (!readStoredCase(c, dataFile, journal, record)) {
+                table->unreadable++;
+                continue;
+            }
+            body = &record;
+        }
+        recordCaseMetrics(*table, c, *body, snap, now);
+    }
+}
+
+void generateSlaReport() {
+    if (reportThread.joinable()) reportThread.join(); // One report at a time
+    CaseSnapshot* snap = takeSnapshot();
+    if (snap == nullptr) {
+        cout << "Too many background tasks running. Please try again shortly." << endl;
+        return;
+    }
+    reportThread = thread(runSlaReport, snap);
+    cout << "Generating SLA report in the background..." << endl;
+}
+
+void runSlaReport(CaseSnapshot* snap) {
+    if (snap->caseCount == 0) {
+        releaseSnapshot(snap);
+        cout << "No cases to report." << endl;
+        return;
+    }
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    long long now = secondsOf(getCurrentDate(), getCurrentTime());
+
+    // Split the ID space at case boundaries; any split points cover every
+    // snapshot case, even if the live store has changed since
+    int workers = (int)thread::hardware_concurrency();
+    workers = max(1, min(workers, min(MAX_SLA_WORKERS, (snap->caseCount + 15) / 16)));
+    int bounds[MAX_SLA_WORKERS + 1];
+    {
+        lock_guard<mutex> lock(storeMutex);
+        bounds[0] = numeric_limits<int>::min();
+        for (int w = 1; w < workers; w++) {
+            int index = (int)((long long)cases.size() * w / workers);
+            bounds[w] = index < cases.size() ? cases[index].id - 1 : numeric_limits<int>::max();
+            bounds[w] = max(bounds[w], bounds[w - 1]);
+        }
+        bounds[workers] = numeric_limits<int>::max();
+    }
+
+    SlaTable* tables = new SlaTable[workers]();
+    thread threads[MAX_SLA_WORKERS];
+    for (int w = 1; w < workers; w++) {
+        threads[w] = thread(collectSlaMetrics, snap, bounds[w], bounds[w + 1], now, &tables[w]);
+    }
+    collectSlaMetrics(snap, bounds[0], bounds[1], now, &tables[0]);
+    for (int w = 1; w < workers; w++) threads[w].join();
+    releaseSnapshot(snap);
+
+    // Merge into the first table
+    SlaTable& total = tables[0];
+    for (int w = 1; w < workers; w++) {
+        for (int g = 0; g < tables[w].groupCount; g++) {
+            const SlaGroup& group = tables[w].groups[g];
+            int slot = slaGroupSlot(total, group.dimension, group.key);
+            if (slot < 0) continue;
+            for (int m = 0; m < SLA_METRICS; m++) mergeHistogram(total.groups[slot].metrics[m], group.metrics[m]);
+        }
+        total.casesSeen += tables[w].casesSeen;
+        total.unreadable += tables[w].unreadable;
+        total.droppedGroups += tables[w].droppedGroups;
+    }
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+
+    string filename = "sla_report_" + getCurrentDate() + ".txt";
+    ofstream report(filename);
+    if (!report) {
+        delete[] tables;
+        cerr << "Error creating report file!" << endl;
+        return;
+    }
+
+    static const char* const METRIC_NAMES[SLA_METRICS] = {
+        "Time to first action", "Time to close", "Age in Open", "Age in Assigned",
+        "Age in In Progress", "Age in Exported"
+    };
+    static const char* const DIMENSION_NAMES[] = { "All cases", "Manager", "Department", "Source" };
+
+    report << "=== SLA and Aging Report ===" << endl;
+    report << "Generated on: " << getCurrentDate() << " at " << getCurrentTime() << endl;
+    report << "Cases analysed: " << total.casesSeen << " (" << workers << " threads, "
+           << (long long)ms << " ms)" << endl;
+    if (total.unreadable > 0) report << "Cases skipped (body unreadable): " << total.unreadable << endl;
+    if (total.droppedGroups > 0) report << "Groups omitted (table full): " << total.droppedGroups << endl;
+    report << "Percentiles are accurate to within 1/" << SLA_SUB_BUCKETS
+           << " of the value. Ages are measured up to now for cases still in that status." << endl;
+
+    for (int dimension = SLA_ALL; dimension <= SLA_SOURCE; dimension++) {
+        for (int g = 0; g < total.groupCount; g++) {
+            const SlaGroup& group = total.groups[g];
+            if (group.dimension != dimension) continue;
+            report << endl << "--- " << DIMENSION_NAMES[dimension];
+            if (dimension != SLA_ALL) report << ": " << (group.key.empty() ? "(none)" : group.key.str());
+            report << " ---" << endl;
+            char line[160];
+            snprintf(line, sizeof(line), "%-22s %6s %10s %10s %10s %10s %10s",
+                     "Metric", "Count", "Mean", "p50", "p90", "p99", "Max");
+            report << line << endl;
+            for (int m = 0; m < SLA_METRICS; m++) {
+                const DurationHistogram& h = group.metrics[m];
+                if (h.total == 0) continue;
+                snprintf(line, sizeof(line), "%-22s %6lld %10s %10s %10s %10s %10s", METRIC_NAMES[m], h.total,
+                         formatDuration(h.sum / h.total).c_str(), formatDuration(histogramPercentile(h, 0.50)).c_str(),
+                         formatDuration(histogramPercentile(h, 0.90)).c_str(),
+                         formatDuration(histogramPercentile(h, 0.99)).c_str(), formatDuration(h.maxValue).c_str());
+                report << line << endl;
+            }
+        }
+    }
+    report.close();
+    delete[] tables;
+    cout << "SLA report generated: " << filename << endl;
+}
+
+// Moves closed cases with no activity for minAgeDays out of the hot store
+// into append-only monthly segments, indexed by ID and date. Returns the
+// number of cases removed from the hot store.
+int archiveClosedCases(int minAgeDays) {
+    ofstream index(ARCHIVE_INDEX_FILE, ios::app);
+    if (!index) {
+        cerr << "Error opening archive index!" << endl;
+        return 0;
+    }
+    ifstream sourceFile(DATA_FILE, ios::binary);
+    ifstream journal;
+    loadArchiveIndex();
+
+    // Copies go to the archive first; the store only changes afterwards, in
+    // one step, so snapshot readers never see it half compacted
+    CaseList<int> leaving; // Indices of cases to drop, ascending
+    for (int i = 0; i < cases.size(); i++) {
+        Case& c = cases[i];
+        PackedDate lastActivity = c.lastActionDate.empty() ? c.creationDate : c.lastActionDate;
+        int age = daysSince(lastActivity.str());
+        bool archive = c.status == "Closed" && age >= 0 && age >= minAgeDays;
+
+        // A crash before the next save can leave a case in both places, and
+        // it must not be appended twice
+        bool alreadyArchived = archive && findArchiveLocation(c.id) != -1;
+
+        if (archive && !alreadyArchived) {
+            const Case* body = &c;
+            Case diskCopy;
+            if (!c.bodyLoaded) {
+                if (!readStoredCase(c, sourceFile, journal, diskCopy)) {
+                    cerr << "Error reading case " << c.id << " for archiving." << endl;
+                    archive = false;
+                }
+                body = &diskCopy;
+            }
+            if (archive) {
+                string segmentName = ARCHIVE_SEGMENT_PREFIX + lastActivity.str().substr(0, 7) + ".txt";
+                ofstream segment(segmentName, ios::app);
+                segment.seekp(0, ios::end);
+                streamoff offset = segment.tellp();
+                writeCaseRecord(segment, c, *body);
+                segment.close();
+                if (!segment) {
+                    cerr << "Error writing archive segment " << segmentName << endl;
+                    archive = false;
+                } else {
+                    index << c.id << " " << c.creationDate << " " << lastActivity << " "
+                          << segmentName << " " << offset << " " << c.title << endl;
+                    emitChange("case.archive", "\"case\":" + to_string(c.id) + ",\"segment\":" + jsonString(segmentName),
+                               addTombstone(c.id, "", true));
+                }
+            }
+        }
+
+        if (archive) leaving.append() = i;
+    }
+
+    lock_guard<mutex> lock(storeMutex);
+    int kept = 0;
+    for (int i = 0, next = 0; i < cases.size(); i++) {
+        if (next < leaving.size() && leaving[next] == i) {
+            prepareCaseWrite(cases[i]);
+            next++;
+        } else {
+            if (kept != i) cases[kept] = cases[i];
+            kept++;
+        }
+    }
+    cases.truncate(kept);
+    return leaving.size();
+}
+
+// Index line format: <id> <created> <closed> <segment> <offset> <title>
+bool parseArchiveEntry(const string& line, ArchiveEntry& entry) {
+    istringstream fields(line);
+    if (!(fields >> entry.id >> entry.creationDate >> entry.closedDate >> entry.segment >> entry.offset)) {
+        return false;
+    }
+    getline(fields, entry.title);
+    if (!entry.title.empty() && entry.title[0] == ' ') entry.title.erase(0, 1);
+    return true;
+}
+
+// Adds the index lines written since the last call to archiveLocations,
+// or rereads the file if it has been replaced by a shorter one. A line
+// still being written is left for the next call.
+void loadArchiveIndex() {
+    ifstream index(ARCHIVE_INDEX_FILE, ios::binary | ios::ate);
+    streamoff size = index ? (streamoff)index.tellg() : 0;
+    if (size < archiveIndexRead) {
+        archiveLocations.clear();
+        archiveIndexRead = 0;
+    }
+    if (size == archiveIndexRead) return;
+    index.seekg(archiveIndexRead);
+    int known = archiveLocations.size();
+    string line;
+    ArchiveEntry entry;
+    while (getline(index, line) && !index.eof()) { // eof: no newline yet
+        archiveIndexRead += line.size() + 1;
+        if (!parseArchiveEntry(line, entry)) continue;
+        ArchiveLocation& location = archiveLocations.append();
+        location.id = entry.id;
+        location.segment = entry.segment;
+        location.offset = entry.offset;
+    }
+    if (archiveLocations.size() == known) return;
+    ArchiveLocation* first = &archiveLocations[0];
+    auto byId = [](const ArchiveLocation& a, const ArchiveLocation& b) { return a.id < b.id; };
+    stable_sort(first + known, first + archiveLocations.size(), byId);
+    inplace_merge(first, first + known, first + archiveLocations.size(), byId);
+}
+
+// archiveLocations index of caseId's record, or -1 if it was not archived
+// as of the last loadArchiveIndex
+int findArchiveLocation(int caseId) {
+    int low = 0, high = archiveLocations.size();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (archiveLocations[mid].id < caseId) low = mid + 1; else high = mid;
+    }
+    return low < archiveLocations.size() && archiveLocations[low].id == caseId ? low : -1;
+}
+
+bool findArchivedCase(int caseId, Case& out) {
+    loadArchiveIndex();
+    int k = findArchiveLocation(caseId);
+    if (k == -1) return false;
+    ifstream segment(archiveLocations[k].segment.str());
+    return segment && readCaseRecord(segment, archiveLocations[k].offset, out) && out.id == caseId;
+}
+
+void searchArchive() {
+    cout << "1. Find by Case ID" << endl;
+    cout << "2. Find by Creation Date Range" << endl;
+    cout << "Enter your choice: ";
+    int choice;
+    cin >> choice;
+    clearInputBuffer();
+
+    if (choice == 1) {
+        cout << "Enter Case ID: ";
+        int caseId;
+        cin >> caseId;
+        clearInputBuffer();
+        Case archivedCase;
+        if (!findArchivedCase(caseId, archivedCase)) {
+            cout << "Case not found in archive." << endl;
+            return;
+        }
+        if (currentUserIsManager && !isManagerAssignedToCase(archivedCase, currentUser)) {
+            cout << "Access denied. You are not assigned to this case." << endl;
+            return;
+        }
+        printCaseDetails(archivedCase);
+        return;
+    }
+    if (choice != 2) {
+        cout << "Invalid choice!" << endl;
+        return;
+    }
+
+    string fromDate, toDate;
+    cout << "Enter start date (YYYY-MM-DD): ";
+    getline(cin, fromDate);
+    cout << "Enter end date (YYYY-MM-DD): ";
+    getline(cin, toDate);
+
+    // Dates are zero-padded, so string comparison orders them correctly
+    ifstream index(ARCHIVE_INDEX_FILE);
+    string line;
+    ArchiveEntry entry;
+    int found = 0;
+    while (getline(index, line)) {
+        if (!parseArchiveEntry(line, entry)) continue;
+        if (entry.creationDate < fromDate || entry.creationDate > toDate) continue;
+        if (currentUserIsManager) {
+            Case archivedCase;
+            if (!findArchivedCase(entry.id, archivedCase) || !isManagerAssignedToCase(archivedCase, currentUser)) {
+                continue;
+            }
+        }
+        if (found == 0) printCaseHeader();
+        Case summary;
+        summary.id = entry.id;
+        summary.title = entry.title;
+        summary.status = "Closed";
+        summary.creationDate = entry.creationDate;
+        printCaseSummary(summary);
+        found++;
+    }
+    if (found == 0) {
+        cout << "No archived cases in that range." << endl;
+    }
+}
+
+// Case queries. A query is a list of terms that must all hold, e.g.
+//   status=Exported source=Email idle>7 dept=IT
+// Symbol fields take "=" or "!=" and alternatives separated by "|"; dates,
+// counts and IDs also take < <= > >=. Values with spaces are quoted.
+bool parseQuery(const string& text, CaseQuery& query, string& error) {
+    query.termCount = 0;
+    size_t pos = 0;
+    while (true) {
+        while (pos < text.length() && text[pos] == ' ') pos++;
+        if (pos >= text.length()) break;
+        string token;
+        bool quoted = false;
+        for (; pos < text.length() && (quoted || text[pos] != ' '); pos++) {
+            if (text[pos] == '"') {
+                quoted = !quoted;
+            } else {
+                token += text[pos];
+            }
+        }
+        if (query.termCount >= MAX_QUERY_TERMS) {
+            error = "too many terms";
+            return false;
+        }
+
+        size_t opPos = token.find_first_of("=!<>");
+        if (opPos == string::npos || opPos == 0) {
+            error = "expected field, operator and value in \"" + token + "\"";
+            return false;
+        }
+        string field = token.substr(0, opPos);
+        size_t valuePos = opPos + 1;
+        QueryTerm& term = query.terms[query.termCount];
+        if (token.compare(opPos, 2, "!=") == 0) {
+            term.op = QUERY_NE;
+            valuePos++;
+        } else if (token.compare(opPos, 2, "<=") == 0) {
+            term.op = QUERY_LE;
+            valuePos++;
+        } else if (token.compare(opPos, 2, ">=") == 0) {
+            term.op = QUERY_GE;
+            valuePos++;
+        } else if (token[opPos] == '<') {
+            term.op = QUERY_LT;
+        } else if (token[opPos] == '>') {
+            term.op = QUERY_GT;
+        } else if (token[opPos] == '=') {
+            term.op = QUERY_EQ;
+        } else {
+            error = "unknown operator in \"" + token + "\"";
+            return false;
+        }
+        string value = token.substr(valuePos);
+        if (value.empty()) {
+            error = "missing value for " + field;
+            return false;
+        }
+
+        bool symbolField = true;
+        if (field == "status") {
+            term.field = QUERY_STATUS;
+        } else if (field == "source") {
+            term.field = QUERY_SOURCE;
+        } else if (field == "manager") {
+            term.field = QUERY_MANAGER;
+        } else if (field == "dept" || field == "department") {
+            term.field = QUERY_DEPARTMENT;
+        } else {
+            symbolField = false;
+            if (field == "created") {
+                term.field = QUERY_CREATED;
+            } else if (field == "actions") {
+                term.field = QUERY_ACTIONS;
+            } else if (field == "idle") {
+                term.field = QUERY_IDLE;
+            } else if (field == "id") {
+                term.field = QUERY_ID;
+            } else {
+                error = "unknown field \"" + field + "\"";
+                return false;
+            }
+        }
+
+        term.valueCount = 0;
+        if (symbolField) {
+            if (term.op != QUERY_EQ && term.op != QUERY_NE) {
+                error = field + " only supports = and !=";
+                return false;
+            }
+            // Values never interned cannot match anything, so they are dropped
+            size_t start = 0;
+            while (start <= value.length()) {
+                size_t bar = value.find('|', start);
+                if (bar == string::npos) bar = value.length();
+                string alternative = value.substr(start, bar - start);
+                if (term.field == QUERY_DEPARTMENT) {
+                    for (int i = 0; i < managers.size(); i++) {
+                        if (managers[i].department == alternative && term.valueCount < MAX_QUERY_VALUES) {
+                            term.values[term.valueCount++] = managers[i].name;
+                        }
+                    }
+                } else {
+                    Symbol symbol;
+                    symbol.id = internString(alternative, false);
+                    if (!symbol.empty() && term.valueCount < MAX_QUERY_VALUES) {
+                        term.values[term.valueCount++] = symbol;
+                    }
+                }
+                start = bar + 1;
+            }
+        } else if (term.field == QUERY_CREATED) {
+            PackedDate date(value);
+            if (date.empty()) {
+                error = "dates are written YYYY-MM-DD";
+                return false;
+            }
+            term.number = date.value;
+        } else {
+            char* end;
+            errno = 0;
+            term.number = strtoll(value.c_str(), &end, 10);
+            if (end == value.c_str() || *end != '\0') {
+                error = field + " needs a number";
+                return false;
+            }
+            if (errno == ERANGE) {
+                error = field + " is out of range";
+                return false;
+            }
+        }
+        query.termCount++;
+    }
+    return true;
+}
+
+bool compareQueryNumber(long long actual, QueryOp op, long long expected) {
+    switch (op) {
+        case QUERY_EQ: return actual == expected;
+        case QUERY_NE: return actual != expected;
+        case QUERY_LT: return actual < expected;
+        case QUERY_LE: return actual <= expected;
+        case QUERY_GT: return actual > expected;
+        case QUERY_GE: return actual >= expected;
+    }
+    return false;
+}
+
+bool caseMatchesQuery(const Case& c, const CaseQuery& query, int today) {
+    for (int t = 0; t < query.termCount; t++) {
+        const QueryTerm& term = query.terms[t];
+        bool found = false;
+        switch (term.field) {
+            case QUERY_STATUS:
+            case QUERY_SOURCE: {
+                Symbol actual = term.field == QUERY_STATUS ? c.status : c.source;
+                for (int v = 0; v < term.valueCount && !found; v++) found = actual == term.values[v];
+                if (found != (term.op == QUERY_EQ)) return false;
+                break;
+            }
+            case QUERY_MANAGER:
+            case QUERY_DEPARTMENT:
+                for (int m = 0; m < c.assignedManagerCount && !found; m++) {
+                    for (int v = 0; v < term.valueCount && !found; v++) {
+                        found = c.assignedManagers[m] == term.values[v];
+                    }
+                }
+                if (found != (term.op == QUERY_EQ)) return false;
+                break;
+            case QUERY_CREATED:
+                if (c.creationDate.empty() || !compareQueryNumber(c.creationDate.value, term.op, term.number)) return false;
+                break;
+            case QUERY_ACTIONS:
+                if (!compareQueryNumber(c.actionCount, term.op, term.number)) return false;
+                break;
+            case QUERY_IDLE: {
+                PackedDate lastActivity = c.lastActionDate.empty() ? c.creationDate : c.lastActionDate;
+                if (lastActivity.empty() || !compareQueryNumber(today - dayNumber(lastActivity), term.op, term.number)) return false;
+                break;
+            }
+            case QUERY_ID:
+                if (!compareQueryNumber(c.id, term.op, term.number)) return false;
+                break;
+        }
+    }
+    return true;
+}
+
+// Narrows [begin, end) of cases[] using the ID order, and the creation date
+// order when it holds, then scans that range. Matches are written as they
+// are found. Returns the match count. Must run on the interactive thread.
+int runQuery(const CaseQuery& query, ostream& out, int& scanned) {
+    int begin = 0, end = cases.size();
+    for (int t = 0; t < query.termCount; t++) {
+        const QueryTerm& term = query.terms[t];
+        if (term.field != QUERY_ID && (term.field != QUERY_CREATED || !creationDatesOrdered)) continue;
+        // First index whose key is above the given value
+        auto firstAbove = [&](long long value) -> int {
+            if (term.field == QUERY_ID) {
+                if (value >= numeric_limits<int>::max()) return cases.size();
+                return findFirstCaseAfter((int)max(value, (long long)numeric_limits<int>::min()));
+            }
+            return findFirstCaseCreatedAfter(value);
+        };
+        // Nothing is below the smallest value, so it needs no subtracting
+        long long below = term.number > numeric_limits<long long>::min() ? term.number - 1 : term.number;
+        switch (term.op) {
+            case QUERY_EQ:
+                begin = max(begin, firstAbove(below));
+                end = min(end, firstAbove(term.number));
+                break;
+            case QUERY_GE: begin = max(begin, firstAbove(below)); break;
+            case QUERY_GT: begin = max(begin, firstAbove(term.number)); break;
+            case QUERY_LE: end = min(end, firstAbove(term.number)); break;
+            case QUERY_LT: end = min(end, firstAbove(below)); break;
+            case QUERY_NE: break;
+        }
+    }
+
+    int today = dayNumber(PackedDate(getCurrentDate()));
+    int matches = 0;
+    out << "ID\tStatus\tSource\tCreated\tLast Action\tActions\tManagers\tTitle\n";
+    for (int i = begin; i < end; i++) {
+        if (!caseMatchesQuery(cases[i], query, today)) continue;
+        writeQueryMatch(out, cases[i]);
+        matches++;
+    }
+    out.flush();
+    scanned = max(end - begin, 0);
+    return matches;
+}
+
+// First index in cases[] created after date (YYYYMMDD); only meaningful
+// while creationDatesOrdered holds
+int findFirstCaseCreatedAfter(long long date) {
+    int low = 0, high = cases.size();
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (cases[mid].creationDate.value <= date) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
+
+// IDs are handed out in creation order, so creation dates normally rise
+// along cases[] too; this checks it after a load so queries can rely on it
+void updateCreationOrder() {
+    creationDatesOrdered = true;
+    for (int i = 0; i < cases.size(); i++) {
+        if (cases[i].creationDate.empty() ||
+            (i > 0 && cases[i].creationDate.value < cases[i - 1].creationDate.value)) {
+            creationDatesOrdered = false;
+            return;
+        }
+    }
+}
+
+void writeQueryMatch(ostream& out, const Case& c) {
+    out << c.id << "\t" << c.status << "\t" << c.source << "\t" << c.creationDate << "\t"
+        << (c.lastActionDate.empty() ? "-" : c.lastActionDate.str()) << "\t" << c.actionCount << "\t";
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        out << (i > 0 ? "," : "") << c.assignedManagers[i];
+    }
+    if (c.assignedManagerCount == 0) out << "-";
+    out << "\t" << c.title << "\n";
+}
+
+void queryCases() {
+    cout << "Fields: status source manager dept (= !=, a|b for either)" << endl;
+    cout << "        created actions idle id (= != < <= > >=)" << endl;
+    cout << "Example: status=Exported source=Email idle>7 dept=IT" << endl;
+    cout << "Enter query: ";
+    string text;
+    getline(cin, text);
+
+    CaseQuery query;
+    string error;
+    if (!parseQuery(text, query, error)) {
+        cout << "Invalid query: " << error << endl;
+        return;
+    }
+    if (currentUserIsManager) {
+        // Managers only ever see their own cases
+        if (query.termCount >= MAX_QUERY_TERMS) {
+            cout << "Invalid query: too many terms" << endl;
+            return;
+        }
+        QueryTerm& own = query.terms[query.termCount++];
+        own.field = QUERY_MANAGER;
+        own.op = QUERY_EQ;
+        own.values[0] = currentUser;
+        own.valueCount = 1;
+    }
+    int scanned;
+    int matches = runQuery(query, cout, scanned);
+    cout << matches << " matching cases (" << scanned << " of " << cases.size() << " scanned)" << endl;
+}
+
+// --query "<terms>": prints matches from the saved data and exits
+int runBatchQuery(const string& text) {
+    CaseQuery query;
+    string error;
+    // Load messages go to stderr so stdout carries only results
+    streambuf* output = cout.rdbuf(cerr.rdbuf());
+    loadData();
+    cout.rdbuf(output);
+    if (!parseQuery(text, query, error)) {
+        cerr << "Invalid query: " << error << endl;
+        return 2;
+    }
+    int scanned;
+    int matches = runQuery(query, cout, scanned);
+    cerr << matches << " matching cases (" << scanned << " of " << cases.size() << " scanned)" << endl;
+    return 0;
+}
+
+// Change feed. Every mutation becomes one JSON line with a sequence number.
+// The interactive thread pushes lines into changeRing without ever waiting.
+// changeFeedLoop appends them to CHANGE_LOG_FILE, which consumers can resume
+// from with --changes-since, and forwards them to the optional live sink
+// (file, FIFO or unix: socket) with non-blocking writes.
+// Appends text as a quoted JSON string, copying runs that need no escape
+// in one go
+void appendJson(string& out, const char* text, size_t length) {
+    out += '"';
+    size_t run = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char ch = text[i];
+        if (ch >= 0x20 && ch != '"' && ch != '\\') continue;
+        out.append(text + run, i - run);
+        run = i + 1;
+        if (ch == '"' || ch == '\\') {
+            out += '\\';
+            out += ch;
+        } else if (ch == '\n') {
+            out += "\\n";
+        } else if (ch == '\t') {
+            out += "\\t";
+        } else {
+            char escape[8];
+            snprintf(escape, sizeof(escape), "\\u%04x", ch);
+            out += escape;
+        }
+    }
+    if (length > 0) out.append(text + run, length - run);
+    out += '"';
+}
+
+string jsonString(const string& text) {
+    string out;
+    appendJson(out, text.data(), text.length());
+    return out;
+}
+
+// Queues one event; fields is the rest of the JSON object, e.g.
+// "\"case\":1001,\"manager\":\"Alice\"". sequence is the number already
+// stamped on the changed record, or 0 to take the next one. Called only by
+// the interactive thread. A full ring never loses an event: it and every
+// later one go to changeSpill until the writer has drained both in order.
+void emitChange(const char* type, const string& fields, long long sequence) {
+    long long seq = sequence > 0 ? sequence : ++changeSequence;
+    ostringstream event;
+    event << "{\"seq\":" << seq << ",\"time\":\"" << getCurrentDate() << "T" << getCurrentTime()
+          << "\",\"type\":\"" << type << "\",\"by\":" << jsonString(currentUser.empty() ? "system" : currentUser);
+    if (!fields.empty()) event << "," << fields;
+    event << "}\n";
+    unsigned int tail = changeRingTail.load(memory_order_relaxed);
+    if (changeSpilling.load(memory_order_acquire) || tail - changeRingHead.load(memory_order_acquire) >= CHANGE_RING_CAPACITY) {
+        lock_guard<mutex> lock(changeFeedMutex);
+        changeSpill += event.str();
+        changeSpilling.store(true, memory_order_release);
+        totalSpilled++;
+    } else {
+        changeRing[tail % CHANGE_RING_CAPACITY] = event.str();
+        changeRingTail.store(tail + 1, memory_order_release);
+    }
+    changeFeedWakeup.notify_one();
+}
+
+// Sequence number carried by an event line, or -1 (gap markers have none)
+long long changeSequenceOf(const string& line) {
+    size_t pos = line.find("\"seq\":");
+    if (pos == string::npos) return -1;
+    return strtoll(line.c_str() + pos + 6, nullptr, 10);
+}
+
+// Highest sequence a logged line accounts for: an event's own, or the end
+// of a gap marker's range; -1 for anything else
+long long changeLoggedThrough(const string& line) {
+    long long seq = changeSequenceOf(line);
+    if (seq >= 0) return seq;
+    size_t to = line.find("\"to\":");
+    return to == string::npos ? -1 : strtoll(line.c_str() + to + 5, nullptr, 10);
+}
+
+// Called once the changes behind events up to sequence are in DATA_FILE or
+// a written journal batch; the feed writer logs events only up to there, so
+// the log never holds an event that a crash could take back
+void noteChangesDurable(long long sequence) {
+    long long durable = durableChangeSequence.load();
+    while (durable < sequence && !durableChangeSequence.compare_exchange_weak(durable, sequence)) {
+    }
+    changeFeedWakeup.notify_one();
+}
+
+// Numbering continues from loadChangeSequence
+void startChangeFeed(const string& sinkTarget) {
+    changeSinkTarget = sinkTarget;
+    // A crash after a save or journal write but before the writer caught up
+    // leaves saved changes without events; the log says so instead of
+    // skipping their numbers silently
+    if (loggedChangeSequence >= 0 && loadedChangeSequence > loggedChangeSequence) {
+        ofstream log(CHANGE_LOG_FILE, ios::app | ios::binary);
+        log << "{\"type\":\"gap\",\"from\":" << loggedChangeSequence + 1 << ",\"to\":" << loadedChangeSequence
+            << ",\"reason\":\"not logged before exit\"}\n";
+    }
+#if IE_POSIX
+    signal(SIGPIPE, SIG_IGN); // A consumer going away must not kill the app
+#endif
+    changeFeedStopping = false;
+    changeFeedThread = thread(changeFeedLoop);
+}
+
+// Drains what is queued and stops the writer
+void stopChangeFeed() {
+    if (!changeFeedThread.joinable()) return;
+    changeFeedStopping = true;
+    changeFeedWakeup.notify_one();
+    changeFeedThread.join();
+    if (totalUnlogged > 0) {
+        cerr << "Change feed: " << totalUnlogged << " events not logged to " << CHANGE_LOG_FILE
+             << " because their changes were not saved" << endl;
+    }
+    if (totalSinkDropped > 0) {
+        cerr << "Change feed: " << totalSinkDropped << " events not delivered to " << changeSinkTarget
+             << " (" << totalSpilled << " queued past a full ring)" << endl;
+    }
+}
+
+#if IE_POSIX
+// Opens the live sink without blocking; -1 while no consumer is there
+int openChangeSink(const string& target) {
+    if (startsWith(target, "unix:")) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0) return -1;
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, target.c_str() + 5, sizeof(address.sun_path) - 1);
+        if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+            close(fd);
+            return -1;
+        }
+        fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+        return fd;
+    }
+    // A FIFO without a reader fails with ENXIO instead of blocking
+    return open(target.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_NONBLOCK, 0644);
+}
+#endif
+
+// Sink delivery state, owned by the feed thread
+struct ChangeSink {
+    int fd = -1;
+    string pending; // Unsent tail of earlier events, at most CHANGE_SINK_BUFFER bytes
+    long long missedFrom = 0, missedTo = 0, missedCount = 0;
+    chrono::steady_clock::time_point nextAttempt;
+};
+
+void deliverChange(ChangeSink& sink, const string& line) {
+#if IE_POSIX
+    if (sink.fd < 0 && chrono::steady_clock::now() >= sink.nextAttempt) {
+        sink.fd = openChangeSink(changeSinkTarget);
+        sink.pending.clear();
+        if (sink.fd < 0) sink.nextAttempt = chrono::steady_clock::now() + chrono::seconds(1);
+    }
+    long long seq = changeSequenceOf(line);
+    if (sink.fd >= 0 && sink.missedCount > 0 && sink.pending.empty()) {
+        sink.pending = "{\"type\":\"gap\",\"from\":" + to_string(sink.missedFrom) + ",\"to\":" +
+            to_string(sink.missedTo) + ",\"reason\":\"slow consumer\"}\n";
+        sink.missedCount = 0;
+    }
+    if (sink.fd < 0 || sink.pending.size() + line.size() > CHANGE_SINK_BUFFER) {
+        if (seq >= 0) {
+            if (sink.missedCount == 0) sink.missedFrom = seq;
+            sink.missedTo = seq;
+            sink.missedCount++;
+            totalSinkDropped++;
+        }
+        return;
+    }
+    sink.pending += line;
+    while (!sink.pending.empty()) {
+        ssize_t written = write(sink.fd, sink.pending.data(), sink.pending.size());
+        if (written > 0) {
+            sink.pending.erase(0, written);
+        } else if (written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break; // Consumer is behind; keep the rest for later
+        } else {
+            close(sink.fd); // Consumer went away; reconnect later
+            sink.fd = -1;
+            sink.nextAttempt = chrono::steady_clock::now() + chrono::seconds(1);
+            break;
+        }
+    }
+#else
+    (void)sink;
+    static ofstream file(changeSinkTarget, ios::app);
+    file << line << flush;
+#endif
+}
+
+void changeFeedLoop() {
+    ofstream log(CHANGE_LOG_FILE, ios::app | ios::binary);
+    ChangeSink sink;
+    string unlogged; // Delivered events whose changes are not durable yet, in order
+    while (true) {
+        bool stopping = changeFeedStopping; // Read first, so the last pass sees the final durable sequence
+        unsigned int head = changeRingHead.load(memory_order_relaxed);
+        unsigned int tail = changeRingTail.load(memory_order_acquire);
+        string batch;
+        for (; head != tail; head++) {
+            string& line = changeRing[head % CHANGE_RING_CAPACITY];
+            batch += line;
+            if (!changeSinkTarget.empty()) deliverChange(sink, line);
+        }
+        changeRingHead.store(head, memory_order_release);
+        if (changeSpilling.load(memory_order_acquire)) {
+            // The producer stopped using the ring when it began spilling, so
+            // whatever is left in the ring precedes every spilled event
+            string spilled;
+            {
+                lock_guard<mutex> lock(changeFeedMutex);
+                for (tail = changeRingTail.load(memory_order_acquire); head != tail; head++) {
+                    string& line = changeRing[head % CHANGE_RING_CAPACITY];
+                    batch += line;
+                    if (!changeSinkTarget.empty()) deliverChange(sink, line);
+                }
+                changeRingHead.store(head, memory_order_release);
+                spilled.swap(changeSpill);
+                changeSpilling.store(false, memory_order_release);
+            }
+            batch += spilled;
+            for (size_t start = 0, end; start < spilled.size(); start = end + 1) {
+                end = spilled.find('\n', start);
+                if (!changeSinkTarget.empty()) deliverChange(sink, spilled.substr(start, end - start + 1));
+            }
+        }
+        unlogged += batch;
+        long long durable = durableChangeSequence.load();
+        size_t ready = 0;
+        for (size_t end; ready < unlogged.size(); ready = end + 1) {
+            end = unlogged.find('\n', ready);
+            if (changeSequenceOf(unlogged.substr(ready, end - ready)) > durable) break;
+        }
+        if (ready > 0) {
+            log.write(unlogged.data(), ready);
+            log.flush();
+            unlogged.erase(0, ready);
+        }
+        if (!changeSinkTarget.empty() && head == tail) deliverChange(sink, ""); // Flush pending bytes
+
+        if (stopping && changeRingTail.load(memory_order_acquire) == head &&
+            !changeSpilling.load(memory_order_acquire)) break;
+        unique_lock<mutex> lock(changeFeedMutex);
+        changeFeedWakeup.wait_for(lock, chrono::milliseconds(200));
+    }
+    totalUnlogged = count(unlogged.begin(), unlogged.end(), '\n');
+#if IE_POSIX
+    if (sink.fd >= 0) close(sink.fd);
+#endif
+}
+
+// --changes-since N: prints logged events after sequence N, and gap
+// markers covering anything after it, so a consumer can catch up
+int printChangesSince(long long sequence) {
+    ifstream log(CHANGE_LOG_FILE, ios::binary);
+    if (!log) {
+        cerr << "No change log (" << CHANGE_LOG_FILE << ")" << endl;
+        return 1;
+    }
+    string line;
+    while (readLine(log, line)) {
+        long long seq = changeSequenceOf(line);
+        if (seq < 0) {
+            size_t to = line.find("\"to\":");
+            if (to == string::npos || strtoll(line.c_str() + to + 5, nullptr, 10) <= sequence) continue;
+        } else if (seq <= sequence) {
+            continue;
+        }
+        cout << line << '\n';
+    }
+    cout.flush();
+    return 0;
+}
+
+// Modification tracking for delta exports. Every change to a case or
+// manager takes the next change feed sequence number, so "changes since N"
+// lines up with the feed. modificationIndex lists (seq, case) in sequence
+// order; an entry is stale once its case has been modified again.
+long long stampCase(Case& c) {
+    c.modifiedSeq = ++changeSequence;
+    c.modifiedDate = getCurrentDate();
+    c.modifiedTime = getCurrentTime();
+    if (modificationIndex.full() || modificationIndex.size() >= 4 * (cases.size() + 16)) {
+        rebuildModificationIndex();
+    }
+    ModificationEntry& entry = modificationIndex.append();
+    entry.seq = c.modifiedSeq;
+    entry.caseId = c.id;
+    return c.modifiedSeq;
+}
+
+long long stampManager(Manager& m) {
+    m.modifiedSeq = ++changeSequence;
+    m.modifiedDate = getCurrentDate();
+    m.modifiedTime = getCurrentTime();
+    return m.modifiedSeq;
+}
+
+// Records a deletion or an archived case; when the table is full the oldest
+// tombstone is dropped and tombstoneHorizon remembers how far deletions are
+// incomplete
+long long addTombstone(int caseId, const string& managerName, bool archived) {
+    if (tombstoneCount == MAX_TOMBSTONES) {
+        tombstoneHorizon = tombstones[0].seq;
+        for (int i = 0; i < tombstoneCount - 1; i++) tombstones[i] = tombstones[i + 1];
+        tombstoneCount--;
+    }
+    Tombstone& t = tombstones[tombstoneCount++];
+    t.caseId = caseId;
+    t.archived = archived;
+    t.managerName = managerName;
+    t.seq = ++changeSequence;
+    t.date = getCurrentDate();
+    t.time = getCurrentTime();
+    return t.seq;
+}
+
+// Rebuilds the index from the live cases: one entry each, sorted by seq
+void rebuildModificationIndex() {
+    modificationIndex.clear();
+    for (int i = 0; i < cases.size(); i++) {
+        if (cases[i].modifiedSeq == 0) continue;
+        ModificationEntry& entry = modificationIndex.append();
+        entry.seq = cases[i].modifiedSeq;
+        entry.caseId = cases[i].id;
+    }
+    if (modificationIndex.size() < 2) return;
+    sort(&modificationIndex[0], &modificationIndex[0] + modificationIndex.size(),
+         [](const ModificationEntry& a, const ModificationEntry& b) { return a.seq < b.seq; });
+}
+
+// "  Modified: <seq> at <date> <time>"
+void writeModifiedLine(ostream& out, long long seq, const PackedDate& date, const PackedTime& time) {
+    if (seq > 0) out << "  Modified: " << seq << " at " << date << " " << time << endl;
+}
+
+bool parseModifiedLine(const string& line, long long& seq, PackedDate& date, PackedTime& time) {
+    size_t atPos = findField(line, " at ");
+    if (!startsWith(line, "  Modified: ") || atPos == string::npos || line.length() < atPos + 23) return false;
+    seq = strtoll(line.c_str() + 12, nullptr, 10);
+    loadDateField(date, line.substr(atPos + 4, 10));
+    loadTimeField(time, line.substr(atPos + 15, 8));
+    return true;
+}
+
+// "Tombstone Case: <id> <seq> at <date> <time>",
+// "Tombstone Archived: <id> <seq> at <date> <time>" or
+// "Tombstone Manager: <seq> at <date> <time> <name>"
+void writeTombstone(ostream& out, const Tombstone& t) {
+    if (t.caseId >= 0) {
+        out << (t.archived ? "Tombstone Archived: " : "Tombstone Case: ") << t.caseId << " " << t.seq << " at " << t.date << " " << t.time << '\n';
+    } else {
+        out << "Tombstone Manager: " << t.seq << " at " << t.date << " " << t.time << " " << t.managerName << '\n';
+    }
+}
+
+// Adds a tombstone read back from the data file or journal, skipping ones
+// already known
+void parseTombstone(const string& line) {
+    Tombstone t;
+    size_t rest;
+    if (startsWith(line, "Tombstone Case: ") || startsWith(line, "Tombstone Archived: ")) {
+        t.archived = line[10] == 'A';
+        char* end;
+        t.caseId = (int)strtol(line.c_str() + (t.archived ? 20 : 16), &end, 10);
+        rest = end - line.c_str();
+    } else if (startsWith(line, "Tombstone Manager: ")) {
+        t.caseId = -1;
+        rest = 18;
+    } else {
+        return;
+    }
+    size_t atPos = findField(line, " at ", rest);
+    if (atPos == string::npos || line.length() < atPos + 23) return;
+    t.seq = strtoll(line.c_str() + rest, nullptr, 10);
+    loadDateField(t.date, line.substr(atPos + 4, 10));
+    loadTimeField(t.time, line.substr(atPos + 15, 8));
+    if (t.caseId < 0) {
+        if (line.length() < atPos + 24) return;
+        t.managerName = line.substr(atPos + 24);
+    }
+    if (tombstoneCount > 0 && t.seq <= tombstones[tombstoneCount - 1].seq) return;
+    if (tombstoneCount == MAX_TOMBSTONES) {
+        tombstoneHorizon = tombstones[0].seq;
+        for (int i = 0; i < tombstoneCount - 1; i++) tombstones[i] = tombstones[i + 1];
+        tombstoneCount--;
+    }
+    tombstones[tombstoneCount++] = t;
+}
+
+// Sequence numbers continue from the highest one in the change log or
+// the data, whichever is further along. Records saved before modification
+// tracking get a stamp here so a full export (since 0) still includes them.
+void loadChangeSequence() {
+    changeSequence = tombstoneHorizon;
+    loggedChangeSequence = -1;
+    ifstream log(CHANGE_LOG_FILE, ios::binary);
+    if (log) {
+        // Reads a growing tail until it holds a whole line with a sequence
+        // number or gap range; a long last event needs more than one block
+        log.seekg(0, ios::end);
+        streamoff size = log.tellg();
+        for (streamoff window = 4096;; window *= 2) {
+            streamoff start = max((streamoff)0, size - window);
+            string tail((size_t)(size - start), '\0');
+            log.clear();
+            log.seekg(start);
+            log.read(&tail[0], tail.size());
+            tail.resize((size_t)log.gcount());
+            size_t first = 0;
+            if (start > 0) { // The first line may be cut off; skip it
+                first = tail.find('\n');
+                first = first == string::npos ? tail.size() : first + 1;
+            }
+            long long found = -1;
+            for (size_t end = tail.size(); end > first && found < 0;) {
+                size_t lineStart = end - 1 > first ? tail.rfind('\n', end - 2) : string::npos;
+                lineStart = lineStart == string::npos || lineStart < first ? first : lineStart + 1;
+                found = changeLoggedThrough(tail.substr(lineStart, end - lineStart));
+                end = lineStart;
+            }
+            if (found >= 0 || start == 0) {
+                loggedChangeSequence = max(found, 0LL);
+                break;
+            }
+        }
+    }
+    loadedChangeSequence = 0;
+    for (int i = 0; i < cases.size(); i++) loadedChangeSequence = max(loadedChangeSequence, cases[i].modifiedSeq);
+    for (int i = 0; i < managers.size(); i++) loadedChangeSequence = max(loadedChangeSequence, managers[i].modifiedSeq);
+    if (tombstoneCount > 0) loadedChangeSequence = max(loadedChangeSequence, tombstones[tombstoneCount - 1].seq);
+    changeSequence = max(changeSequence, max(loggedChangeSequence, loadedChangeSequence));
+    journaledTombstoneSeq = tombstoneCount > 0 ? tombstones[tombstoneCount - 1].seq : 0;
+
+    for (int i = 0; i < cases.size(); i++) {
+        if (cases[i].modifiedSeq > 0) continue;
+        cases[i].modifiedSeq = ++changeSequence;
+        cases[i].modifiedDate = cases[i].creationDate;
+        cases[i].modifiedTime = cases[i].creationTime;
+    }
+    for (int i = 0; i < managers.size(); i++) {
+        if (managers[i].modifiedSeq == 0) stampManager(managers[i]);
+    }
+    durableChangeSequence = changeSequence; // Nothing loaded has an event waiting
+    rebuildModificationIndex();
+}
+
+string csvField(const string& text) {
+    if (text.find_first_of(",\"\n\r") == string::npos) return text;
+    string out = "\"";
+    for (size_t i = 0; i < text.length(); i++) {
+        if (text[i] == '"') out += '"';
+        out += text[i];
+    }
+    return out + "\"";
+}
+
+string isoTime(const PackedDate& date, const PackedTime& time) {
+    return date.str() + "T" + time.str();
+}
+
+void writeDeltaCase(ostream& out, const Case& c, const Case& body, bool csv) {
+    if (csv) {
+        string assigned;
+        for (int i = 0; i < c.assignedManagerCount; i++) {
+            assigned += (i > 0 ? ";" : "") + c.assignedManagers[i].str();
+        }
+        out << "case," << c.id << "," << c.modifiedSeq << "," << isoTime(c.modifiedDate, c.modifiedTime) << ",0,"
+            << csvField(c.status.str()) << "," << csvField(c.source.str()) << ","
+            << isoTime(c.creationDate, c.creationTime) << ",,," << csvField(assigned) << ","
+            << body.actionCount << "," << csvField(c.title.str()) << "," << csvField(body.description.str()) << "\n";
+        return;
+    }
+    out << "{\"kind\":\"case\",\"id\":" << c.id << ",\"seq\":" << c.modifiedSeq
+        << ",\"modified\":\"" << isoTime(c.modifiedDate, c.modifiedTime) << "\""
+        << ",\"title\":" << jsonString(c.title.str()) << ",\"description\":" << jsonString(body.description.str())
+        << ",\"created\":\"" << isoTime(c.creationDate, c.creationTime) << "\""
+        << ",\"source\":" << jsonString(c.source.str()) << ",\"status\":" << jsonString(c.status.str())
+        << ",\"managers\":[";
+    for (int i = 0; i < c.assignedManagerCount; i++) {
+        out << (i > 0 ? "," : "") << jsonString(c.assignedManagers[i].str());
+    }
+    out << "],\"actions\":[";
+    for (int i = 0; i < body.actionCount; i++) {
+        const Action& a = body.actions[i];
+        out << (i > 0 ? "," : "") << "{\"time\":\"" << isoTime(a.date, a.time) << "\",\"manager\":"
+            << jsonString(a.manager.str()) << ",\"description\":" << jsonString(a.description.str()) << "}";
+    }
+    out << "]}\n";
+}
+
+void writeDeltaManager(ostream& out, const Manager& m, bool csv) {
+    if (csv) {
+        out << "manager," << csvField(m.name) << "," << m.modifiedSeq << "," << isoTime(m.modifiedDate, m.modifiedTime)
+            << ",0,,,," << csvField(m.department.str()) << "," << (m.active ? 1 : 0) << ",,,,\n";
+        return;
+    }
+    out << "{\"kind\":\"manager\",\"name\":" << jsonString(m.name) << ",\"seq\":" << m.modifiedSeq
+        << ",\"modified\":\"" << isoTime(m.modifiedDate, m.modifiedTime) << "\",\"department\":"
+        << jsonString(m.department.str()) << ",\"active\":" << (m.active ? "true" : "false") << "}\n";
+}
+
+void writeDeltaTombstone(ostream& out, const Tombstone& t, bool csv) {
+    string key = t.caseId >= 0 ? to_string(t.caseId) : (csv ? csvField(t.managerName) : jsonString(t.managerName));
+    if (csv) {
+        out << (t.caseId >= 0 ? "case," : "manager,") << key << "," << t.seq << "," << isoTime(t.date, t.time)
+            << (t.archived ? ",1,Archived,,,,,,,,\n" : ",1,,,,,,,,,\n");
+        return;
+    }
+    out << "{\"kind\":\"" << (t.caseId >= 0 ? "case\",\"id\":" : "manager\",\"name\":") << key
+        << ",\"seq\":" << t.seq << ",\"modified\":\"" << isoTime(t.date, t.time) << "\",\"deleted\":true"
+        << (t.archived ? ",\"status\":\"Archived\"}\n" : "}\n");
+}
+
+// Writes every case, manager and deletion changed after sequence `since`,
+// in sequence order, then a watermark to pass as `since` next time. Cases
+// come from modificationIndex, so the work follows the size of the delta.
+// Returns the number of records written. Must run on the interactive thread.
+int exportChangesSince(long long since, bool csv, ostream& out) {
+    if (since > 0 && since < tombstoneHorizon) {
+        cerr << "Warning: deletions up to sequence " << tombstoneHorizon
+             << " are no longer tracked; export from 0 for a full resync." << endl;
+    }
+    if (csv) {
+        out << "kind,key,seq,modified,deleted,status,source,created,department,active,managers,actions,title,description\n";
+    }
+
+    // Managers are few; order the changed ones by sequence
+    int changedManagers[MAX_MANAGERS];
+    int changedManagerCount = 0;
+    for (int i = 0; i < managers.size(); i++) {
+        if (managers[i].modifiedSeq <= since) continue;
+        int j = changedManagerCount++;
+        while (j > 0 && managers[changedManagers[j - 1]].modifiedSeq > managers[i].modifiedSeq) {
+            changedManagers[j] = changedManagers[j - 1];
+            j--;
+        }
+        changedManagers[j] = i;
+    }
+
+    int low = 0, high = modificationIndex.size();
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (modificationIndex[mid].seq <= since) low = mid + 1; else high = mid;
+    }
+    int entry = low;
+    low = 0;
+    high = tombstoneCount;
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (tombstones[mid].seq <= since) low = mid + 1; else high = mid;
+    }
+    int tombstone = low;
+    int manager = 0;
+
+    ifstream sourceFile(DATA_FILE, ios::binary);
+    ifstream journal;
+    int written = 0;
+    while (true) {
+        const long long none = numeric_limits<long long>::max();
+        long long caseSeq = entry < modificationIndex.size() ? modificationIndex[entry].seq : none;
+        long long tombstoneSeq = tombstone < tombstoneCount ? tombstones[tombstone].seq : none;
+        long long managerSeq = manager < changedManagerCount ? managers[changedManagers[manager]].modifiedSeq : none;
+        if (caseSeq == none && tombstoneSeq == none && managerSeq == none) break;
+
+        if (caseSeq < tombstoneSeq && caseSeq < managerSeq) {
+            int index = findFirstCaseAfter(modificationIndex[entry].caseId - 1);
+            entry++;
+            if (index >= cases.size() || cases[index].id != modificationIndex[entry - 1].caseId ||
+                cases[index].modifiedSeq != caseSeq) {
+                continue; // Modified again later, or deleted
+            }
+            const Case& c = cases[index];
+            const Case* body = &c;
+            Case diskCopy;
+            if (!c.bodyLoaded) {
+                if (!readStoredCase(c, sourceFile, journal, diskCopy)) {
+                    cerr << "Error reading case " << c.id << " from disk." << endl;
+                    continue;
+                }
+                body = &diskCopy;
+            }
+            writeDeltaCase(out, c, *body, csv);
+        } else if (tombstoneSeq < managerSeq) {
+            writeDeltaTombstone(out, tombstones[tombstone++], csv);
+        } else {
+            writeDeltaManager(out, managers[changedManagers[manager++]], csv);
+        }
+        written++;
+    }
+    if (csv) {
+        out << "watermark,," << changeSequence << ",,,,,,,,,,,\n";
+    } else {
+        out << "{\"kind\":\"watermark\",\"seq\":" << changeSequence << "}\n";
+    }
+    out.flush();
+    return written;
+}
+
+void exportChangesMenu() {
+    if (currentUserIsManager) {
+        cout << "Only admin can export changes." << endl;
+        return;
+    }
+    cout << "Export changes after sequence number (0 for everything): ";
+    long long since;
+    if (!(cin >> since)) {
+        clearInputBuffer();
+        cout << "Invalid sequence number." << endl;
+        return;
+    }
+    clearInputBuffer();
+    cout << "Format (json/csv): ";
+    string format;
+    getline(cin, format);
+    bool csv = format == "csv";
+    if (!csv && format != "json") {
+        cout << "Unknown format." << endl;
+        return;
+    }
+
+    string filename = "changes_since_" + to_string(since) + (csv ? ".csv" : ".jsonl");
+    ofstream out(filename);
+    if (!out) {
+        cerr << "Error opening " << filename << endl;
+        return;
+    }
+    int written = exportChangesSince(since, csv, out);
+    cout << written << " changed records written to " << filename
+         << " (next export: after " << changeSequence << ")" << endl;
+}
+
+// --export-changes N [json|csv]: writes the delta to stdout and exits
+int runBatchExport(long long since, const string& format) {
+    if (format != "json" && format != "csv") {
+        cerr << "Format must be json or csv" << endl;
+        return 2;
+    }
+    streambuf* output = cout.rdbuf(cerr.rdbuf());
+    loadData();
+    cout.rdbuf(output);
+    exportChangesSince(since, format == "csv", cout);
+    return 0;
+}
+
+// Serializes the store in parallel, writes it to a temporary file that is
+// flushed to disk, and renames it over DATA_FILE, so a crash or power loss
+// at any point leaves either the old or the new file intact
+void saveData() {
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+
+    ostringstream header;
+    header << "=== MANAGERS ===\n";
+    for (int i = 0; i < managers.size(); i++) {
+        header << "Manager " << (i+1) << ":\n";
+        writeManagerRecord(header, managers[i]);
+        header << '\n'; // Blank line between managers
+    }
+    header << "=== CASES ===\n";
+    string headerText = header.str();
+
+    // Case ranges are serialized by separate threads; only this thread
+    // changes the store, so the workers can read it without locking
+    CaseList<streamoff> newOffsets;
+    for (int i = 0; i < cases.size(); i++) newOffsets.append() = 0;
+    int workers = (int)thread::hardware_concurrency();
+    workers = max(1, min(workers, min(MAX_SAVE_WORKERS, (cases.size() + SAVE_CASES_PER_WORKER - 1) / SAVE_CASES_PER_WORKER)));
+    SaveChunk chunks[MAX_SAVE_WORKERS];
+    thread threads[MAX_SAVE_WORKERS];
+    for (int w = 0; w < workers; w++) {
+        chunks[w].begin = (int)((long long)cases.size() * w / workers);
+        chunks[w].end = (int)((long long)cases.size() * (w + 1) / workers);
+        if (w > 0) threads[w] = thread(serializeCaseRange, &chunks[w], &newOffsets);
+    }
+    serializeCaseRange(&chunks[0], &newOffsets);
+    for (int w = 1; w < workers; w++) threads[w].join();
+    for (int w = 0; w < workers; w++) {
+        if (chunks[w].failedCaseId >= 0) {
+            cerr << "Error reading case " << chunks[w].failedCaseId << " from disk. Save aborted." << endl;
+            return;
+        }
+    }
+
+    // Deletions, for delta exports, then system information
+    ostringstream trailer;
+    trailer << "=== TOMBSTONES ===\n";
+    for (int i = 0; i < tombstoneCount; i++) {
+        writeTombstone(trailer, tombstones[i]);
+    }
+    trailer << "=== SYSTEM ===\n";
+    trailer << "Next Case ID: " << nextCaseId << '\n';
+    if (tombstoneHorizon > 0) trailer << "Tombstone Horizon: " << tombstoneHorizon << '\n';
+    string trailerText = trailer.str();
+
+    const string* parts[MAX_SAVE_WORKERS + 2];
+    int partCount = 0;
+    parts[partCount++] = &headerText;
+    streamoff base = headerText.size();
+    for (int w = 0; w < workers; w++) {
+        for (int i = chunks[w].begin; i < chunks[w].end; i++) newOffsets[i] += base;
+        base += chunks[w].text.size();
+        parts[partCount++] = &chunks[w].text;
+    }
+    parts[partCount++] = &trailerText;
+
+    string tempFile = DATA_FILE + ".tmp";
+    if (!writeFileDurably(tempFile, parts, partCount)) {
+        cerr << "Error writing data file!" << endl;
+        remove(tempFile.c_str());
+        return;
+    }
+    if (rename(tempFile.c_str(), DATA_FILE.c_str()) != 0) {
+#if IE_POSIX
+        cerr << "Error replacing data file!" << endl;
+        return;
+#else
+        remove(DATA_FILE.c_str()); // Some platforms refuse to rename over an existing file
+        if (rename(tempFile.c_str(), DATA_FILE.c_str()) != 0) {
+            cerr << "Error replacing data file!" << endl;
+            return;
+        }
+#endif
+    }
+    syncDirectory();
+    noteChangesDurable(changeSequence);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    double bytes = (double)base + trailerText.size();
+    unsigned long long hash = hashBytes(nullptr, 0);
+    for (int p = 0; p < partCount; p++) hash = hashBytes(parts[p]->data(), parts[p]->size(), hash);
+
+    loadedDataSize = (unsigned long long)bytes;
+    loadedDataHash = hash;
+
+    // Bodies now match the new file, so they become evictable again. Those
+    // of new and journal-replayed cases were never in residentBodies; they
+    // are dropped rather than left resident without a bound.
+    lock_guard<mutex> lock(storeMutex);
+    for (int i = 0; i < cases.size(); i++) {
+        if (cases[i].bodyLoaded && cases[i].recordOffset < 0) evictCaseBody(cases[i]);
+        cases[i].recordOffset = newOffsets[i];
+        cases[i].journalOffset = -1;
+        cases[i].bodyModified = false;
+        cases[i].dirty = false;
+    }
+    for (int i = 0; i < managers.size(); i++) {
+        managers[i].dirty = false;
+    }
+    deletedCaseIds.clear();
+    deletedManagerCount = 0;
+
+    // Everything autosaved so far is now in the data file
+    {
+        lock_guard<mutex> fileLock(journalFileMutex);
+        lock_guard<mutex> queueLock(autosaveMutex);
+        pendingJournal.clear();
+        pendingBodies.clear();
+        journaledBodies.clear();
+        pendingRecords = 0;
+        remove(JOURNAL_FILE.c_str());
+    }
+    publishReplica(); // Record offsets now point into the new file
+    cout << "Data saved successfully with improved formatting." << endl;
+    char line[160];
+    snprintf(line, sizeof(line), "Wrote %d cases, %.1f KB in %.1f ms (%.1f MB/s, %d thread%s)", cases.size(),
+             bytes / 1024, ms, bytes / 1048.576 / max(ms, 0.001), workers, workers == 1 ? "" : "s");
+    cout << line << endl;
+}
+
+// Serializes cases [chunk->begin, chunk->end) into chunk->text, storing
+// each record's offset within the text in offsets. Bodies that are not
+// loaded are read from the current data file (or the journal, once
+// evicted with changes) through this worker's own streams; records are in
+// file order, so the reads are mostly sequential.
+void serializeCaseRange(SaveChunk* chunk, CaseList<streamoff>* offsets) {
+    ifstream sourceFile;
+    ifstream journal;
+    ostringstream out;
+    for (int i = chunk->begin; i < chunk->end; i++) {
+        const Case& c = cases[i];
+        const Case* body = &c;
+        Case diskCopy;
+        if (!c.bodyLoaded) {
+            if (!readStoredCase(c, sourceFile, journal, diskCopy)) {
+                chunk->failedCaseId = c.id;
+                return;
+            }
+            body = &diskCopy;
         }
-        cout << "Enter your choice: ";
-    
-        int choice;
-        cin >> choice;
-        clearInputBuffer();
+        (*offsets)[i] = out.tellp();
+        writeCaseRecord(out, c, *body);
+    }
+    chunk->text = out.str();
+}
 
-        if ((!currentUserIsManager && choice == 10) || (currentUserIsManager && choice == 7)) {
-            break;
+// Writes the parts to path in order, as few vectored writes as the system
+// allows, and returns only once they are on stable storage
+bool writeFileDurably(const string& path, const string* const parts[], int partCount) {
+#if IE_POSIX
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    iovec vectors[MAX_SAVE_WORKERS + 2];
+    int vectorCount = 0;
+    for (int i = 0; i < partCount && vectorCount < MAX_SAVE_WORKERS + 2; i++) {
+        if (parts[i]->empty()) continue;
+        vectors[vectorCount].iov_base = (void*)parts[i]->data();
+        vectors[vectorCount].iov_len = parts[i]->size();
+        vectorCount++;
+    }
+    int first = 0;
+    while (first < vectorCount) {
+        ssize_t written = writev(fd, vectors + first, vectorCount - first);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            close(fd);
+            return false;
         }
-        
-        if (currentUserIsManager) {
-            if (choice >= 4) choice += 3;
+        // A short write leaves the rest of a part for the next call
+        while (first < vectorCount && (size_t)written >= vectors[first].iov_len) {
+            written -= vectors[first].iov_len;
+            first++;
         }
-    
-        switch (choice) {
-            case 1: addCase(); break;
-            case 2: viewCases(); break;
-            case 3: {
-                cout << "Enter Case ID: ";
-                int caseId;
-                cin >> caseId;
-                clearInputBuffer();
-                viewCaseDetails(caseId);
-                break;
-            }
-            case 4: assignManagerToCase(); break;
-            case 5: editCase(); break;
-            case 6: deleteCase(); break;
-            case 7: addActionToCase(); break;
-            case 8: exportCase(); break;
-            case 9: closeCase(); break;
-            default: cout << "Invalid choice!" << endl;
+        if (first < vectorCount) {
+            vectors[first].iov_base = (char*)vectors[first].iov_base + written;
+            vectors[first].iov_len -= written;
         }
     }
+    bool synced = fsync(fd) == 0;
+    return close(fd) == 0 && synced;
+#else
+    ofstream out(path, ios::binary);
+    for (int i = 0; i < partCount; i++) out.write(parts[i]->data(), parts[i]->size());
+    out.close();
+    return !out.fail();
+#endif
 }
 
-void managerManagementMenu() {
-    while (true) {
-        cout << "\n=== Manager Management ===" << endl;
-        cout << "1. Add New Manager" << endl;
-        cout << "2. View All Managers" << endl;
-        cout << "3. Edit Manager" << endl;
-        cout << "4. Toggle Manager Status" << endl;
-        cout << "5. Delete Manager" << endl;
-        cout << "6. Back to Main Menu" << endl;
-        cout << "Enter your choice: ";
-        
-        int choice;
-        cin >> choice;
-        clearInputBuffer();
-        
-        if (choice == 6) break;
-        
-        switch (choice) {
-            case 1: addManager(); break;
-            case 2: viewManagers(); break;
-            case 3: editManager(); break;
-            case 4: toggleManagerStatus(); break;
-            case 5: deleteManager(); break;
-            default: cout << "Invalid choice!" << endl;
+// Appends text to path and returns only once it is on stable storage;
+// start is set to the offset in path where text begins
+bool appendFileDurably(const string& path, const string& text, streamoff& start) {
+#if IE_POSIX
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+    if (fd < 0) return false;
+    start = lseek(fd, 0, SEEK_END);
+    for (size_t done = 0; done < text.size();) {
+        ssize_t written = write(fd, text.data() + done, text.size() - done);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            close(fd);
+            return false;
         }
+        done += written;
     }
+    bool synced = fsync(fd) == 0;
+    return close(fd) == 0 && synced;
+#else
+    ofstream out(path, ios::binary | ios::app);
+    out.seekp(0, ios::end);
+    start = out.tellp();
+    out.write(text.data(), text.size());
+    out.close();
+    return !out.fail();
+#endif
 }
 
-void reportMenu() {
-    while (true) {
-        cout << "\n=== Reports ===" << endl;
-        cout << "1. Generate Case Report" << endl;
-        cout << "2. Back to Main Menu" << endl;
-        cout << "Enter your choice: ";
-        
-        int choice;
-        cin >> choice;
-        clearInputBuffer();
-        
-        if (choice == 2) break;
-        
-        switch (choice) {
-            case 1: generateReport(); break;
-            default: cout << "Invalid choice!" << endl;
+// Makes a rename in the working directory (where DATA_FILE lives) durable
+void syncDirectory() {
+#if IE_POSIX
+    int fd = open(".", O_RDONLY);
+    if (fd < 0) return;
+    fsync(fd);
+    close(fd);
+#endif
+}
+
+// FNV-1a, continuing from hash; stamps DATA_FILE as loaded or saved
+unsigned long long hashBytes(const char* data, size_t length, unsigned long long hash) {
+    for (size_t i = 0; i < length; i++) hash = (hash ^ (unsigned char)data[i]) * 1099511628211ULL;
+    return hash;
+}
+
+// Writes one case record; body supplies description and actions, which
+// may come from a disk copy when the live case has not loaded them
+void writeCaseRecord(ostream& out, const Case& c, const Case& body) {
+    out << "Case ID: " << c.id << '\n';
+    out << "  Title: " << c.title << '\n';
+    out << "  Description: " << body.description << '\n';
+    out << "  Created: " << c.creationDate << " at " << c.creationTime << '\n';
+    out << "  Source: " << c.source << '\n';
+    out << "  Status: " << c.status << '\n';
+    writeModifiedLine(out, c.modifiedSeq, c.modifiedDate, c.modifiedTime);
+    
+    // Save assigned managers
+    out << "  Assigned Managers (" << c.assignedManagerCount << "):\n";
+    for (int j = 0; j < c.assignedManagerCount; j++) {
+        out << "    - " << c.assignedManagers[j] << '\n';
+    }
+    
+    // Save actions
+    out << "  Actions (" << body.actionCount << "):\n";
+    for (int j = 0; j < body.actionCount; j++) {
+        out << "    - " << body.actions[j].date << " " << body.actions[j].time 
+            << " by " << body.actions[j].manager << ": " 
+            << body.actions[j].description << '\n';
+    }
+    out << '\n'; // Blank line between cases
+}
+
+void writeManagerRecord(ostream& out, const Manager& m) {
+    out << "  Name: " << m.name << '\n';
+    out << "  Department: " << m.department << '\n';
+    out << "  Password: " << m.password << '\n';
+    writeModifiedLine(out, m.modifiedSeq, m.modifiedDate, m.modifiedTime);
+    out << "  Status: " << (m.active ? "Active" : "Inactive") << '\n';
+}
+
+// Parses one line of a case record into c. Description and action text are
+// only materialized when withBody is set; otherwise actions are just counted.
+void parseCaseLine(Case& c, const string& line, CaseListMode& listMode, bool withBody) {
+    if (startsWith(line, "  Title: ")) {
+        c.title.assign(line.data() + 9, line.length() - 9);
+    } else if (startsWith(line, "  Description: ")) {
+        if (withBody) c.description.assign(line.data() + 15, line.length() - 15);
+    } else if (startsWith(line, "  Created: ")) {
+        size_t atPos = findField(line, " at ");
+        if (atPos != string::npos) {
+            loadDateField(c.creationDate, line.substr(11, atPos - 11));
+            loadTimeField(c.creationTime, line.substr(atPos + 4));
+        }
+    } else if (startsWith(line, "  Source: ")) {
+        c.source = line.substr(10);
+    } else if (startsWith(line, "  Status: ")) {
+        c.status = line.substr(10);
+    } else if (startsWith(line, "  Modified: ")) {
+        parseModifiedLine(line, c.modifiedSeq, c.modifiedDate, c.modifiedTime);
+    } else if (startsWith(line, "  Assigned Managers (")) {
+        c.assignedManagerCount = 0; // Reset count before reading managers
+        listMode = LIST_MANAGERS;
+    } else if (startsWith(line, "  Actions (")) {
+        c.actionCount = 0; // Reset count before reading actions
+        listMode = LIST_ACTIONS;
+    } else if (startsWith(line, "    - ")) {
+        if (listMode == LIST_MANAGERS && c.assignedManagerCount < MAX_ASSIGNED_MANAGERS) {
+            c.assignedManagers[c.assignedManagerCount++] = line.substr(6);
+        } else if (listMode == LIST_ACTIONS && c.actionCount < MAX_ACTIONS) {
+            size_t byPos = findField(line, " by ");
+            size_t colonPos = findField(line, ": ", byPos);
+            if (byPos != string::npos && colonPos != string::npos) {
+                size_t spacePos = findField(line, " ", 6);
+                if (spacePos < byPos) {
+                    PackedTime time; // Checked even for summaries, so loadData sees bad ones
+                    loadDateField(c.lastActionDate, line.substr(6, spacePos - 6));
+                    loadTimeField(time, line.substr(spacePos + 1, byPos - (spacePos + 1)));
+                    if (withBody) {
+                        Action& a = c.actions[c.actionCount];
+                        a.date = c.lastActionDate;
+                        a.time = time;
+                        a.manager = line.substr(byPos + 4, colonPos - (byPos + 4));
+                        a.description.assign(line.data() + colonPos + 2, line.length() - (colonPos + 2));
+                    }
+                    c.actionCount++;
+                }
+            }
         }
     }
 }
 
-void addCase() {
-    if (caseCount >= MAX_CASES) {
-        cout << "Maximum number of cases reached!" << endl;
-        return;
+// Reads the full case record starting at offset (a "Case ID:" line)
+bool readCaseRecord(istream& in, streamoff offset, Case& out) {
+    if (offset < 0) return false;
+    in.clear();
+    in.seekg(offset);
+
+    thread_local string line; // Reused so steady-state body loads don't allocate
+    if (!readLine(in, line) || !startsWith(line, "Case ID: ")) return false;
+    try {
+        out.id = stoi(line.substr(9));
+    } catch (...) {
+        return false;
     }
 
-    Case& newCase = cases[caseCount];
-    newCase.id = nextCaseId++;
-    cout << "Enter case title: ";
-    getline(cin, newCase.title);
-    cout << "Enter case description: ";
-    getline(cin, newCase.description);
-    newCase.creationDate = getCurrentDate();
-    newCase.creationTime = getCurrentTime();
-    cout << "Enter case source: ";
-    getline(cin, newCase.source);
-    newCase.status = "Open";
-    newCase.assignedManagerCount = 0;
-    newCase.actionCount = 0;
+    CaseListMode listMode = LIST_NONE;
+    while (readLine(in, line)) {
+        if (startsWith(line, "Case ID: ") || startsWith(line, "=== ")) break;
+        parseCaseLine(out, line, listMode, true);
+    }
+    return true;
+}
 
-    caseCount++;
-    cout << "Case added successfully with ID: " << newCase.id << endl;
+// Reads the stored record of a case whose body is not loaded: its journal
+// record when the body was evicted with changes, otherwise its DATA_FILE
+// record. Each stream is opened on first use.
+bool readStoredCase(const Case& c, ifstream& dataFile, ifstream& journal, Case& out) {
+    bool journaled = c.journalOffset >= 0;
+    ifstream& in = journaled ? journal : dataFile;
+    if (!in.is_open()) in.open(journaled ? JOURNAL_FILE : DATA_FILE, ios::binary);
+    return readCaseRecord(in, journaled ? c.journalOffset : c.recordOffset, out) && out.id == c.id;
 }
 
-void viewCases(bool brief) {
-    if (caseCount == 0) {
-        cout << "No cases found." << endl;
-        return;
+// Faults in the description and actions of a case, evicting the least
+// recently used body that is stored when too many are resident
+bool loadCaseBody(Case& c) {
+    if (c.bodyLoaded) {
+        if (c.recordOffset >= 0) touchResidentBody(c.id);
+        return true;
+    }
+    if (residentBodyCount == MAX_LOADED_BODIES) makeRoomForBody();
+
+    // A body evicted with changes is read back from the journal, any other
+    // from the data file at its offset
+    ifstream dataFile;
+    ifstream journal;
+    Case record;
+    if (!readStoredCase(c, dataFile, journal, record)) return false;
+
+    lock_guard<mutex> lock(storeMutex);
+    c.description.swap(record.description);
+    c.actionCount = record.actionCount;
+    for (int i = 0; i < record.actionCount; i++) {
+        c.actions[i].description.swap(record.actions[i].description);
+        c.actions[i].date = record.actions[i].date;
+        c.actions[i].time = record.actions[i].time;
+        c.actions[i].manager = record.actions[i].manager;
+    }
+    c.bodyLoaded = true;
+    if (c.journalOffset >= 0) c.journaledSeq = c.modifiedSeq; // Only the summary can have changed since
+    touchResidentBody(c.id);
+    return true;
+}
+
+// Moves a case to the most recently used end of residentBodies, adding it
+// if it is not there; the caller makes room first
+void touchResidentBody(int caseId) {
+    int k = 0;
+    while (k < residentBodyCount && residentBodies[k] != caseId) k++;
+    if (k == residentBodyCount) {
+        if (residentBodyCount == MAX_LOADED_BODIES) return;
+        residentBodyCount++;
     }
+    for (; k + 1 < residentBodyCount; k++) residentBodies[k] = residentBodies[k + 1];
+    residentBodies[residentBodyCount - 1] = caseId;
+}
 
-    if (brief) {
-        printCaseHeader();
-        for (int i = 0; i < caseCount; i++) {
-            if (!currentUserIsManager || isManagerAssignedToCase(cases[i], currentUser)) {
-                printCaseSummary(cases[i]);
+void dropResidentBody(int k) {
+    for (; k + 1 < residentBodyCount; k++) residentBodies[k] = residentBodies[k + 1];
+    residentBodyCount--;
+}
+
+// Evicts the least recently used body that is stored: one that matches
+// DATA_FILE, or a modified one whose current record the autosave writer
+// has made durable in the journal. When every resident body has changes
+// not yet written, the writer is stopped to write them and restarted, so
+// modified bodies count against MAX_LOADED_BODIES like the rest without a
+// save in mid-session.
+void makeRoomForBody() {
+    for (int pass = 0; pass < 2; pass++) {
+        noteJournaledBodies();
+        for (int k = 0; k < residentBodyCount; k++) {
+            int index = findCaseIndex(residentBodies[k]);
+            if (index != -1 && cases[index].bodyLoaded && cases[index].bodyModified &&
+                (cases[index].journalOffset < 0 || cases[index].journaledSeq != cases[index].modifiedSeq)) {
+                continue;
             }
-        }
-    } else {
-        bool hasCases = false;
-        for (int i = 0; i < caseCount; i++) {
-            if (!currentUserIsManager || isManagerAssignedToCase(cases[i], currentUser)) {
-                viewCaseDetails(cases[i].id);
-                cout << "------------------------" << endl;
-                hasCases = true;
+            if (index != -1 && cases[index].bodyLoaded) {
+                lock_guard<mutex> lock(storeMutex);
+                evictCaseBody(cases[index]);
             }
+            dropResidentBody(k); // Evicted, or the case was deleted or archived
+            return;
         }
-        if (currentUserIsManager && !hasCases) {
-            cout << "You are not assigned to any cases." << endl;
+        if (pass == 0 && autosaveThread.joinable()) {
+            stopAutosave();
+            startAutosave();
         }
     }
 }
 
-bool viewCaseDetails(int caseId) {
-    int index = findCaseIndex(caseId);
-    if (index == -1) {
-        cout << "Case not found." << endl;
-        return false;
+// Notes on cases[] the journal records of modified bodies the writer has
+// made durable. A case changed again since keeps waiting for a later one.
+void noteJournaledBodies() {
+    HeapStorage::List<JournaledBody> written;
+    {
+        lock_guard<mutex> lock(autosaveMutex);
+        written = journaledBodies;
+        journaledBodies.clear();
     }
+    lock_guard<mutex> lock(storeMutex);
+    for (int i = 0; i < written.size(); i++) {
+        int index = findCaseIndex(written[i].caseId);
+        if (index == -1 || cases[index].modifiedSeq != written[i].modifiedSeq) continue;
+        cases[index].journalOffset = written[i].offset;
+        cases[index].journaledSeq = written[i].modifiedSeq;
+    }
+}
 
-    Case& c = cases[index];
+// Caller holds storeMutex
+void evictCaseBody(Case& c) {
+    c.description = Text();
+    for (int i = 0; i < c.actionCount; i++) {
+        c.actions[i] = Action();
+    }
+    c.bodyLoaded = false;
+}
 
-    if (currentUserIsManager && !isManagerAssignedToCase(c, currentUser)) {
-        cout << "Access denied. You are not assigned to this case." << endl;
-        return false;
+void loadData() {
+    // The file is read in LOAD_BLOCK_SIZE blocks, each split into lines with
+    // the vectorized scanner, so memory use does not grow with the file
+    ifstream dataFile(DATA_FILE, ios::binary);
+    loadedDataSize = 0;
+    loadedDataHash = hashBytes(nullptr, 0);
+    if (!dataFile) {
+        cout << "No existing data file found. Starting with empty database." << endl;
+        replayJournal();
+        updateCreationOrder();
+        rebuildLoadHeaps();
+        loadChangeSequence();
+        return;
     }
 
-    cout << "\n=== Case Details ===" << endl;
-    cout << "ID: " << c.id << endl;
-    cout << "Title: " << c.title << endl;
-    cout << "Description: " << c.description << endl;
-    cout << "Created: " << c.creationDate << " at " << c.creationTime << endl;
-    cout << "Source: " << c.source << endl;
-    cout << "Status: " << c.status << endl;
+    string line;
+    string currentSection;
+    managers.truncate(0);
+    cases.truncate(0);
+    unpackableFields = 0;
+    nextCaseId = 1000;
+    Manager manager; // Appended once its status line is read
+
+    // Only case summaries are kept; each record's offset is remembered so
+    // loadCaseBody can fetch the description and actions later
+    bool caseOpen = false;
+    CaseListMode listMode = LIST_NONE;
+    string block; // Unscanned tail of the last block, then the next one
+    streamoff blockOffset = 0; // Where block starts in the file
+    bool lastBlock = false;
+    while (!lastBlock) {
+        size_t carried = block.size();
+        block.resize(carried + LOAD_BLOCK_SIZE);
+        dataFile.read(&block[carried], LOAD_BLOCK_SIZE);
+        size_t got = (size_t)dataFile.gcount();
+        block.resize(carried + got);
+        loadedDataSize += got;
+        loadedDataHash = hashBytes(block.data() + carried, got, loadedDataHash);
+        lastBlock = got < LOAD_BLOCK_SIZE;
+        const char* start = block.data();
+        size_t lastNewline = block.rfind('\n');
+        // A line cut off by the end of the block waits for the next one
+        const char* end = lastBlock ? start + block.size() : lastNewline == string::npos ? start : start + lastNewline + 1;
+
+        for (const char* p = start; p < end; ) {
+            streamoff offset = blockOffset + (p - start);
+            const char* lineEnd;
+            const char* next = nextLine(p, end, lineEnd);
+            line.assign(p, lineEnd);
+            p = next;
+            if (line.empty() || line[0] == '#') continue; // Skip blank lines or comments
+
+            // Detect section headers in the data file
+            if (startsWith(line, "=== ")) {
+                caseOpen = false; // A section header ends the last case
+            }
+            if (line.find("=== MANAGERS ===") != string::npos) {
+                currentSection = "managers";
+                continue;
+            } else if (line.find("=== CASES ===") != string::npos) {
+                currentSection = "cases";
+                continue;
+            } else if (line.find("=== TOMBSTONES ===") != string::npos) {
+                currentSection = "tombstones";
+                continue;
+            } else if (line.find("=== SYSTEM ===") != string::npos) {
+                currentSection = "system";
+                continue;
+            }
 
-    cout << "\nAssigned Managers (" << c.assignedManagerCount << "):" << endl;
-    for (int i = 0; i < c.assignedManagerCount; i++) {
-        cout << " - " << c.assignedManagers[i] << endl;
+            // Parse data based on current section
+            if (currentSection == "managers" && !managers.full()) {
+                if (startsWith(line, "Manager ")) {
+                    manager = Manager(); // Marker line; actual data comes in next few lines
+                } else if (startsWith(line, "  Name: ")) {
+                    manager.name = line.substr(8);
+                } else if (startsWith(line, "  Department: ")) {
+                    manager.department = line.substr(14);
+                } else if (startsWith(line, "  Password: ")) {
+                    manager.password = line.substr(12);
+                } else if (startsWith(line, "  Modified: ")) {
+                    parseModifiedLine(line, manager.modifiedSeq, manager.modifiedDate, manager.modifiedTime);
+                } else if (startsWith(line, "  Status: ")) {
+                    manager.active = (line.substr(10) == "Active");
+                    managers.append(manager); // Manager complete once status is read
+                }
+            }
+            else if (currentSection == "cases") {
+                if (startsWith(line, "Case ID: ")) {
+                    caseOpen = false; // Previous case ends where the next begins
+                    if (cases.full()) continue;
+                    try {
+                        Case summary;
+                        summary.id = stoi(line.substr(9));
+                        summary.bodyLoaded = false;
+                        summary.recordOffset = offset;
+                        cases.append(summary);
+                        caseOpen = true;
+                        listMode = LIST_NONE;
+                        // Ensure nextCaseId stays ahead of highest ID found
+                        if (summary.id >= nextCaseId) {
+                            nextCaseId = summary.id + 1;
+                        }
+                    } catch (...) {
+                        cerr << "Error parsing case ID" << endl;
+                        continue;
+                    }
+                } else if (caseOpen) {
+                    parseCaseLine(cases[cases.size() - 1], line, listMode, false);
+                }
+            }
+            else if (currentSection == "tombstones") {
+                parseTombstone(line);
+            }
+            else if (currentSection == "system") {
+                if (startsWith(line, "Next Case ID: ")) {
+                    try {
+                        nextCaseId = stoi(line.substr(14));
+                    } catch (...) {
+                        cerr << "Error parsing next case ID" << endl;
+                    }
+                } else if (startsWith(line, "Tombstone Horizon: ")) {
+                    tombstoneHorizon = max(tombstoneHorizon, strtoll(line.c_str() + 19, nullptr, 10));
+                }
+            }
+        }
+        blockOffset += end - start;
+        block.erase(0, end - start);
+    }
+    if (unpackableFields > 0) {
+        // Saving would write these fields back empty
+        cerr << "Error: " << DATA_FILE << " has " << unpackableFields << " dates or times that are not "
+             << "YYYY-MM-DD / HH:MM:SS, first \"" << firstUnpackableField << "\". Correct them and restart." << endl;
+        exit(1);
     }
 
-    cout << "\nActions (" << c.actionCount << "):" << endl;
-    for (int i = 0; i < c.actionCount; i++) {
-        cout << " - " << c.actions[i].date << " " << c.actions[i].time 
-             << " by " << c.actions[i].manager << ": " 
-             << c.actions[i].description << endl;
+    replayJournal();
+    updateCreationOrder();
+    rebuildLoadHeaps();
+    loadChangeSequence();
+    cout << "Data loaded successfully from readable format. " 
+         << cases.size() << " cases and " << managers.size() << " managers found." << endl;
+}
+
+// Takes a point-in-time view of the case store in O(1); returns nullptr
+// when all MAX_SNAPSHOTS slots are in use. Must be called by the
+// interactive thread, which is the only writer of managers[].
+CaseSnapshot* takeSnapshot() {
+    lock_guard<mutex> lock(storeMutex);
+    for (int s = 0; s < MAX_SNAPSHOTS; s++) {
+        CaseSnapshot& snap = snapshots[s];
+        if (snap.active) continue;
+        snap.active = true;
+        snap.epoch = ++storeVersion;
+        snap.preimages.clear();
+        snap.caseCount = cases.size();
+        snap.nextCaseId = nextCaseId;
+        snap.managerCount = managers.size();
+        for (int i = 0; i < managers.size(); i++) {
+            snap.managers[i] = managers[i];
+        }
+        return &snap;
     }
+    return nullptr;
+}
+
+void releaseSnapshot(CaseSnapshot* snap) {
+    lock_guard<mutex> lock(storeMutex);
+    for (int i = 0; i < snap->preimages.size(); i++) {
+        delete snap->preimages[i];
+    }
+    snap->preimages.clear();
+    snap->active = false;
+}
 
+// Copies the case with the smallest ID greater than afterId as it was when
+// the snapshot was taken. Safe to call from any thread.
+bool snapshotNextCase(CaseSnapshot* snap, int afterId, Case& out) {
+    lock_guard<mutex> lock(storeMutex);
+    const Case* next = nullptr;
+    // Live cases written since the snapshot are either new (skip) or have
+    // their old contents in the preimages
+    for (int i = findFirstCaseAfter(afterId); i < cases.size(); i++) {
+        if (cases[i].version < snap->epoch) {
+            next = &cases[i];
+            break;
+        }
+    }
+    for (int i = 0; i < snap->preimages.size(); i++) {
+        const Case* old = snap->preimages[i];
+        if (old->id > afterId && (next == nullptr || old->id < next->id)) {
+            next = old;
+        }
+    }
+    if (next == nullptr) return false;
+    out = *next;
     return true;
 }
 
-void assignManagerToCase() {
-    if (currentUserIsManager) {
-        cout << "Only admin can assign managers to cases." << endl;
-        return;
+// Must be called with storeMutex held before a case is modified or
+// removed, so active snapshots keep its current contents
+void prepareCaseWrite(Case& c) {
+    for (int s = 0; s < MAX_SNAPSHOTS; s++) {
+        CaseSnapshot& snap = snapshots[s];
+        if (snap.active && c.version < snap.epoch) {
+            snap.preimages.append() = new Case(c);
+        }
     }
+    c.version = storeVersion;
+}
 
-    cout << "Enter Case ID: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
+// cases[] stays in ascending ID order: new IDs always exceed existing
+// ones and removals shift the tail down
+int findFirstCaseAfter(int caseId) {
+    int low = 0, high = cases.size();
+    while (low < high) {
+        int mid = (low + high) / 2;
+        if (cases[mid].id <= caseId) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    return low;
+}
 
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
-        return;
+void startAutosave() {
+    autosaveStopping = false;
+    autosaveThread = thread(autosaveLoop);
+}
+
+// Flushes anything still pending and waits for the writer to finish
+void stopAutosave() {
+    if (!autosaveThread.joinable()) return;
+    autosaveCommit();
+    {
+        lock_guard<mutex> lock(autosaveMutex);
+        autosaveStopping = true;
+    }
+    autosaveWakeup.notify_one();
+    autosaveThread.join();
+}
+
+// Background writer: serializes handed-off batches from their snapshots as
+// soon as they arrive, and appends them to the journal every
+// AUTOSAVE_INTERVAL_SECONDS, or sooner once enough records are pending
+void autosaveLoop() {
+    chrono::steady_clock::time_point lastWrite = chrono::steady_clock::now();
+    while (true) {
+        AutosaveBatch batches[MAX_SNAPSHOTS];
+        int batchCount;
+        bool stopping;
+        {
+            unique_lock<mutex> lock(autosaveMutex);
+            autosaveWakeup.wait_until(lock, lastWrite + chrono::seconds(AUTOSAVE_INTERVAL_SECONDS), [] {
+                return autosaveStopping || autosaveQueueCount > 0 || pendingRecords >= AUTOSAVE_RECORD_THRESHOLD;
+            });
+            batchCount = autosaveQueueCount;
+            for (int i = 0; i < batchCount; i++) {
+                batches[i] = autosaveQueue[i];
+            }
+            autosaveQueueCount = 0;
+            stopping = autosaveStopping;
+        }
+
+        for (int i = 0; i < batchCount; i++) {
+            ostringstream out;
+            out << batches[i].records;
+            HeapStorage::List<JournaledBody> bodies;
+            Case c;
+            for (int j = 0; j < batches[i].caseIds.size(); j++) {
+                int caseId = batches[i].caseIds[j];
+                if (snapshotNextCase(batches[i].snap, caseId - 1, c) && c.id == caseId) {
+                    if (c.bodyLoaded && c.bodyModified && c.recordOffset >= 0) {
+                        JournaledBody& body = bodies.append();
+                        body.caseId = c.id;
+                        body.modifiedSeq = c.modifiedSeq;
+                        body.offset = out.tellp();
+                    }
+                    writeJournalCase(out, c);
+                }
+            }
+            if (batches[i].snap) releaseSnapshot(batches[i].snap);
+            out << "Next Case ID: " << batches[i].nextCaseId << endl;
+            out << "=== COMMIT ===" << endl; // Replay ignores a batch cut off by a crash
+
+            lock_guard<mutex> lock(autosaveMutex);
+            for (int j = 0; j < bodies.size(); j++) {
+                bodies[j].offset += pendingJournal.size();
+                pendingBodies.append() = bodies[j];
+            }
+            pendingJournal += out.str();
+            pendingJournalSeq = batches[i].changeSequence;
+            pendingRecords += batches[i].recordCount;
+        }
+
+        string text;
+        long long textSeq = 0;
+        HeapStorage::List<JournaledBody> textBodies;
+        {
+            lock_guard<mutex> fileLock(journalFileMutex);
+            {
+                lock_guard<mutex> lock(autosaveMutex);
+                bool due = chrono::steady_clock::now() - lastWrite >= chrono::seconds(AUTOSAVE_INTERVAL_SECONDS);
+                if (stopping || due || pendingRecords >= AUTOSAVE_RECORD_THRESHOLD) {
+                    text.swap(pendingJournal);
+                    textSeq = pendingJournalSeq;
+                    textBodies = pendingBodies;
+                    pendingBodies.clear();
+                    pendingRecords = 0;
+                    lastWrite = chrono::steady_clock::now();
+                }
+            }
+            streamoff start;
+            if (!text.empty()) {
+                if (appendFileDurably(JOURNAL_FILE, text, start)) {
+                    noteChangesDurable(textSeq);
+                    // The interactive thread may now evict these bodies
+                    lock_guard<mutex> lock(autosaveMutex);
+                    for (int j = 0; j < textBodies.size(); j++) {
+                        textBodies[j].offset += start;
+                        journaledBodies.append() = textBodies[j];
+                    }
+                } else {
+                    cerr << "Autosave failed: could not write " << JOURNAL_FILE << endl;
+                }
+            }
+        }
+        if (stopping) return;
+    }
+}
+
+// Journal form of a case; a summary-only record when the body was never
+// loaded, which replay merges onto the body already in DATA_FILE
+void writeJournalCase(ostream& out, const Case& c) {
+    if (c.bodyLoaded) {
+        writeCaseRecord(out, c, c);
+    } else {
+        Case summaryOnly;
+        summaryOnly.actionCount = 0;
+        out << "Body Unchanged" << endl;
+        writeCaseRecord(out, c, summaryOnly);
+    }
+}
+
+// Called by the interactive thread after each command. Collects the IDs of
+// records changed since the last call and hands them to the writer with an
+// O(1) snapshot, so serialization and disk I/O both happen off this thread.
+void autosaveCommit() {
+    if (changeSequence != replicaPublishedSeq) publishReplica(); // Even when the journal writer is behind
+    noteJournaledBodies();
+    {
+        lock_guard<mutex> lock(autosaveMutex);
+        if (autosaveQueueCount == MAX_SNAPSHOTS) return; // Writer is behind; retry next command
+    }
+
+    AutosaveBatch batch;
+    ostringstream records;
+    batch.recordCount = 0;
+
+    for (int i = 0; i < managers.size(); i++) {
+        if (!managers[i].dirty) continue;
+        records << "Manager:" << endl;
+        writeManagerRecord(records, managers[i]);
+        managers[i].dirty = false;
+        batch.recordCount++;
+    }
+    for (int i = 0; i < deletedManagerCount; i++) {
+        records << "Deleted Manager: " << deletedManagerNames[i] << endl;
+        batch.recordCount++;
     }
-
-    Case& c = cases[caseIndex];
-    if (c.assignedManagerCount >= MAX_ASSIGNED_MANAGERS) {
-        cout << "Maximum managers already assigned to this case." << endl;
-        return;
+    deletedManagerCount = 0;
+    for (int i = 0; i < deletedCaseIds.size(); i++) {
+        records << "Deleted Case: " << deletedCaseIds[i] << endl;
+        batch.recordCount++;
+    }
+    deletedCaseIds.clear();
+    for (int i = 0; i < tombstoneCount; i++) {
+        if (tombstones[i].seq <= journaledTombstoneSeq) continue;
+        writeTombstone(records, tombstones[i]);
+        journaledTombstoneSeq = tombstones[i].seq;
     }
 
-    cout << "Available Managers:" << endl;
-    for (int i = 0; i < managerCount; i++) {
-        if (managers[i].active) {
-            cout << " - " << managers[i].name << " (" << managers[i].department << ")" << endl;
+    {
+        lock_guard<mutex> lock(storeMutex);
+        for (int i = 0; i < cases.size(); i++) {
+            if (!cases[i].dirty) continue;
+            batch.caseIds.append() = cases[i].id;
+            cases[i].dirty = false;
         }
     }
+    batch.recordCount += batch.caseIds.size();
+    if (batch.recordCount == 0) return;
+
+    batch.snap = nullptr;
+    if (batch.caseIds.size() > 0) {
+        batch.snap = takeSnapshot();
+        if (batch.snap == nullptr) {
+            // Every snapshot slot is busy; serialize here instead
+            for (int i = 0; i < batch.caseIds.size(); i++) {
+                writeJournalCase(records, cases[findCaseIndex(batch.caseIds[i])]);
+            }
+            batch.caseIds.clear();
+        }
+    }
+    batch.records = records.str();
+    batch.nextCaseId = nextCaseId;
+    batch.changeSequence = changeSequence;
 
-    cout << "Enter manager name to assign: ";
-    string managerName;
-    getline(cin, managerName);
+    {
+        lock_guard<mutex> lock(autosaveMutex);
+        autosaveQueue[autosaveQueueCount++] = batch;
+    }
+    autosaveWakeup.notify_one();
+}
 
-    int managerIndex = findManagerIndex(managerName);
-    if (managerIndex == -1 || !managers[managerIndex].active) {
-        cout << "Manager not found or inactive." << endl;
-        return;
+void markCaseDeleted(int caseId) {
+    if (deletedCaseIds.full()) autosaveCommit();
+    deletedCaseIds.append() = caseId;
+}
+
+void markManagerDeleted(const string& managerName) {
+    if (deletedManagerCount == MAX_MANAGERS) autosaveCommit();
+    deletedManagerNames[deletedManagerCount++] = managerName;
+}
+
+// Ingestion. Producer threads parse input and enqueue records without
+// taking a lock or waiting for each other; the applier, the only thread
+// that writes the store in this mode, applies them in batches and hands
+// each batch to autosave as one journal commit.
+void resetIngestQueue() {
+    for (unsigned int i = 0; i < INGEST_QUEUE_CAPACITY; i++) {
+        ingestQueue[i].sequence.store(i, memory_order_relaxed);
     }
+    ingestTail.store(0);
+    ingestHead.store(0);
+    ingestFullRetries = 0;
+    ingestMalformed = 0;
+}
 
-    for (int i = 0; i < c.assignedManagerCount; i++) {
-        if (c.assignedManagers[i] == managerName) {
-            cout << "Manager already assigned to this case." << endl;
-            return;
+// Swaps record into the queue; false, leaving record as it was, when the
+// queue is full. Safe to call from any number of threads at once.
+bool tryEnqueueIngest(IngestRecord& record) {
+    unsigned int position = ingestTail.load(memory_order_relaxed);
+    while (true) {
+        IngestCell& cell = ingestQueue[position % INGEST_QUEUE_CAPACITY];
+        int lag = (int)(cell.sequence.load(memory_order_acquire) - position);
+        if (lag < 0) return false; // The applier has not emptied this cell yet
+        if (lag > 0) {
+            position = ingestTail.load(memory_order_relaxed); // Another producer took it
+        } else if (ingestTail.compare_exchange_weak(position, position + 1, memory_order_relaxed)) {
+            swap(cell.record, record);
+            cell.sequence.store(position + 1, memory_order_release);
+            return true;
         }
     }
+}
+
+// Takes the oldest record, or returns false if it is not yet filled. Only
+// the applier calls this.
+bool tryDequeueIngest(IngestRecord& record) {
+    unsigned int position = ingestHead.load(memory_order_relaxed);
+    IngestCell& cell = ingestQueue[position % INGEST_QUEUE_CAPACITY];
+    if (cell.sequence.load(memory_order_acquire) != position + 1) return false;
+    swap(cell.record, record);
+    cell.sequence.store(position + INGEST_QUEUE_CAPACITY, memory_order_release);
+    ingestHead.store(position + 1, memory_order_release);
+    return true;
+}
+
+// The same ring behind one mutex, as the --bench-ingest baseline
+bool lockedEnqueueIngest(IngestRecord& record) {
+    lock_guard<mutex> lock(ingestLock);
+    unsigned int tail = ingestTail.load(memory_order_relaxed);
+    if (tail - ingestHead.load(memory_order_relaxed) == INGEST_QUEUE_CAPACITY) return false;
+    swap(ingestQueue[tail % INGEST_QUEUE_CAPACITY].record, record);
+    ingestTail.store(tail + 1, memory_order_relaxed);
+    return true;
+}
+
+bool lockedDequeueIngest(IngestRecord& record) {
+    lock_guard<mutex> lock(ingestLock);
+    unsigned int head = ingestHead.load(memory_order_relaxed);
+    if (head == ingestTail.load(memory_order_relaxed)) return false;
+    swap(ingestQueue[head % INGEST_QUEUE_CAPACITY].record, record);
+    ingestHead.store(head + 1, memory_order_relaxed);
+    return true;
+}
 
-    c.assignedManagers[c.assignedManagerCount++] = managerName;
-    if (c.status == "Open") {
-        c.status = "Assigned";
+// Parses one --ingest line, fields separated by tabs:
+//   case    source   title    description
+//   action  case ID  author   text
+bool parseIngestLine(const string& line, IngestRecord& record) {
+    size_t first = line.find('\t');
+    size_t second = first == string::npos ? first : line.find('\t', first + 1);
+    size_t third = second == string::npos ? second : line.find('\t', second + 1);
+    if (third == string::npos) return false;
+    if (line.compare(0, first, "case") == 0) {
+        record.kind = INGEST_CASE;
+        record.source.assign(line, first + 1, second - first - 1);
+        record.title.assign(line, second + 1, third - second - 1);
+        record.author.clear();
+    } else if (line.compare(0, first, "action") == 0) {
+        record.kind = INGEST_ACTION;
+        char* end;
+        record.caseId = (int)strtol(line.c_str() + first + 1, &end, 10);
+        if (end == line.c_str() + first + 1 || end != line.c_str() + second) return false;
+        record.author.assign(line, second + 1, third - second - 1);
+    } else {
+        return false;
     }
-    cout << "Manager assigned successfully." << endl;
+    record.text.assign(line, third + 1, string::npos);
+    return true;
 }
 
-// Adds a new action log entry to a specified case, only if manager is assigned
-void addActionToCase() {
-    cout << "Enter Case ID: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
+// Producer thread: enqueues the records read from in, yielding while the
+// queue is full
+void ingestProducer(istream* in, atomic<int>* activeProducers) {
+    string line;
+    IngestRecord record;
+    while (readLine(*in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        if (!parseIngestLine(line, record)) {
+            ingestMalformed++;
+            continue;
+        }
+        while (!tryEnqueueIngest(record)) {
+            ingestFullRetries++;
+            this_thread::yield();
+        }
+    }
+    activeProducers->fetch_sub(1, memory_order_release);
+}
 
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
+void applyIngestRecord(const IngestRecord& record, IngestStats& stats) {
+    currentUser = record.author; // Credited in the change feed
+    if (record.kind == INGEST_CASE) {
+        if (cases.full()) {
+            stats.rejected++;
+            return;
+        }
+        DuplicateMatch match;
+        createCase(record.title, record.text, record.source, match);
+        stats.casesAdded++;
+        if (match.duplicateOf != -1) stats.duplicates++;
         return;
     }
-
-    Case& c = cases[caseIndex];
-    if (c.actionCount >= MAX_ACTIONS) {
-        cout << "Maximum actions reached for this case." << endl;
+    // The author is credited with the action, so it must be an active manager
+    int managerIndex = findManagerIndex(record.author);
+    int caseIndex = findCaseIndex(record.caseId);
+    if (managerIndex == -1 || !managers[managerIndex].active || caseIndex == -1 ||
+        cases[caseIndex].actionCount >= MAX_ACTIONS || !loadCaseBody(cases[caseIndex])) {
+        stats.rejected++;
         return;
     }
+    recordCaseAction(cases[caseIndex], record.text, record.author);
+    stats.actionsAdded++;
+}
 
-    // Ensure manager is assigned before adding action
-    if (currentUserIsManager) {
-        bool isAssigned = false;
-        for (int i = 0; i < c.assignedManagerCount; i++) {
-            if (c.assignedManagers[i] == currentUser) {
-                isAssigned = true;
-                break;
-            }
+// Applies queued records, INGEST_BATCH at a time, until every producer has
+// finished and the queue is empty. Runs on the thread that owns the store.
+void applyIngestQueue(const atomic<int>& activeProducers, IngestStats& stats) {
+    IngestRecord record;
+    while (true) {
+        // Read before draining: once no producer is left, an empty queue stays empty
+        bool finished = activeProducers.load(memory_order_acquire) == 0;
+        unsigned int depth = ingestTail.load(memory_order_relaxed) - ingestHead.load(memory_order_relaxed);
+        int applied = 0;
+        while (applied < INGEST_BATCH && tryDequeueIngest(record)) {
+            applyIngestRecord(record, stats);
+            applied++;
         }
-        if (!isAssigned) {
-            cout << "You are not assigned to this case." << endl;
+        if (applied > 0) {
+            stats.batches++;
+            stats.depthTotal += depth;
+            stats.maxDepth = max(stats.maxDepth, depth);
+            autosaveCommit();
+        } else if (finished) {
             return;
+        } else {
+            this_thread::yield();
         }
     }
+}
 
-    // Prompt for action description
-    Action& action = c.actions[c.actionCount++];
-    cout << "Enter action description: ";
-    getline(cin, action.description);
-    action.date = getCurrentDate();
-    action.time = getCurrentTime();
-    action.manager = currentUser;
+// --ingest file...: applies the records in each file, read by one producer
+// thread per file, then saves
+int runIngest(int fileCount, char* files[]) {
+    if (fileCount > MAX_INGEST_PRODUCERS) {
+        cerr << "At most " << MAX_INGEST_PRODUCERS << " input files" << endl;
+        return 2;
+    }
+    // Every input is opened before anything is loaded, so a bad argument
+    // fails the run without applying the other files
+    ifstream inputs[MAX_INGEST_PRODUCERS];
+    istream* streams[MAX_INGEST_PRODUCERS];
+    bool stdinTaken = false;
+    for (int i = 0; i < fileCount; i++) {
+        if (string(files[i]) == "-") {
+            if (stdinTaken) {
+                cerr << "Standard input (-) can only be given once" << endl;
+                return 2;
+            }
+            stdinTaken = true;
+            streams[i] = &cin;
+            continue;
+        }
+        inputs[i].open(files[i], ios::binary);
+        if (!inputs[i]) {
+            cerr << "Cannot open " << files[i] << endl;
+            return 1;
+        }
+        streams[i] = &inputs[i];
+    }
 
-    // Update status from Assigned -> In Progress if needed
-    if (c.status == "Assigned") {
-        c.status = "In Progress";
+    loadData();
+    buildDuplicateIndex();
+    startChangeFeed("");
+    startAutosave();
+    resetIngestQueue();
+
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    atomic<int> activeProducers(fileCount);
+    thread producers[MAX_INGEST_PRODUCERS];
+    for (int i = 0; i < fileCount; i++) {
+        producers[i] = thread(ingestProducer, streams[i], &activeProducers);
     }
+    IngestStats stats;
+    applyIngestQueue(activeProducers, stats);
+    for (int i = 0; i < fileCount; i++) producers[i].join();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    currentUser.clear();
 
-    cout << "Action added successfully." << endl;
+    stopAutosave();
+    saveData();
+    stopChangeFeed();
+
+    long long records = stats.casesAdded + stats.actionsAdded + stats.rejected;
+    char line[240];
+    snprintf(line, sizeof(line), "Ingested %lld cases (%lld likely duplicates) and %lld actions (%lld rejected, %lld "
+             "malformed) from %d producer%s in %.1f ms, %.0f records/s", stats.casesAdded, stats.duplicates,
+             stats.actionsAdded, stats.rejected,
+             ingestMalformed.load(), fileCount, fileCount == 1 ? "" : "s", ms, records * 1000.0 / max(ms, 0.001));
+    cout << line << endl;
+    snprintf(line, sizeof(line), "Queue depth at each of %lld batches: mean %.1f, max %u of %u; %lld enqueues retried "
+             "on a full queue", stats.batches, (double)stats.depthTotal / max(stats.batches, 1LL), stats.maxDepth,
+             INGEST_QUEUE_CAPACITY, ingestFullRetries.load());
+    cout << line << endl;
+    return stats.rejected > 0 || ingestMalformed > 0 ? 1 : 0;
 }
 
-// Exports a case to another manager by assigning them and logging the reason as an action
-void exportCase() {
-    cout << "Enter Case ID: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
-
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
-        return;
+void benchIngestProducer(int count, bool locked, atomic<int>* activeProducers) {
+    IngestRecord record;
+    record.text = "bench action"; // Short enough to stay in the string itself
+    for (int i = 0; i < count; i++) {
+        record.caseId = i;
+        while (!(locked ? lockedEnqueueIngest(record) : tryEnqueueIngest(record))) {
+            ingestFullRetries++;
+            this_thread::yield();
+        }
     }
+    activeProducers->fetch_sub(1, memory_order_release);
+}
 
-    Case& c = cases[caseIndex];
-
-    if (c.status == "Closed") {
-        cout << "Case is already closed and cannot be exported." << endl;
-        return;
+// --bench-ingest [records]: 1 to MAX_INGEST_PRODUCERS producers enqueue
+// records as fast as they can while one consumer drains them in batches,
+// through the lock-free queue and through the same ring behind a mutex
+int runIngestBenchmark(int records) {
+    if (records <= 0) {
+        cerr << "Record count must be positive" << endl;
+        return 1;
     }
+    cout << records << " records per run, queue of " << INGEST_QUEUE_CAPACITY << ", batches of " << INGEST_BATCH
+         << ", " << thread::hardware_concurrency() << " hardware thread(s)" << endl;
+    char line[200];
+    snprintf(line, sizeof(line), "%9s  %-8s %12s %11s %10s %12s", "Producers", "Queue", "Records/s", "Mean depth",
+             "Max depth", "Full retries");
+    cout << line << endl;
+    for (int producerCount = 1; producerCount <= MAX_INGEST_PRODUCERS; producerCount *= 2) {
+        for (int locked = 0; locked < 2; locked++) {
+            resetIngestQueue();
+            chrono::steady_clock::time_point started = chrono::steady_clock::now();
+            atomic<int> activeProducers(producerCount);
+            thread producers[MAX_INGEST_PRODUCERS];
+            for (int p = 0; p < producerCount; p++) {
+                int count = records / producerCount + (p < records % producerCount ? 1 : 0);
+                producers[p] = thread(benchIngestProducer, count, locked != 0, &activeProducers);
+            }
 
-    // Display active managers not already assigned to the case
-    cout << "Available Managers:" << endl;
-    int availableCount = 0;
-    for (int i = 0; i < managerCount; i++) {
-        if (managers[i].active) {
-            bool alreadyAssigned = false;
-            for (int j = 0; j < c.assignedManagerCount; j++) {
-                if (c.assignedManagers[j] == managers[i].name) {
-                    alreadyAssigned = true;
+            IngestRecord record;
+            long long received = 0, batches = 0, depthTotal = 0;
+            unsigned int maxDepth = 0;
+            while (true) {
+                bool finished = activeProducers.load(memory_order_acquire) == 0;
+                unsigned int depth = ingestTail.load(memory_order_relaxed) - ingestHead.load(memory_order_relaxed);
+                int taken = 0;
+                while (taken < INGEST_BATCH && (locked ? lockedDequeueIngest(record) : tryDequeueIngest(record))) {
+                    taken++;
+                }
+                if (taken > 0) {
+                    received += taken;
+                    batches++;
+                    depthTotal += depth;
+                    maxDepth = max(maxDepth, depth);
+                } else if (finished) {
                     break;
+                } else {
+                    this_thread::yield();
                 }
             }
-            if (!alreadyAssigned) {
-                cout << " - " << managers[i].name << " (" << managers[i].department << ")" << endl;
-                availableCount++;
-            }
+            for (int p = 0; p < producerCount; p++) producers[p].join();
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - started).count();
+
+            snprintf(line, sizeof(line), "%9d  %-8s %12.0f %11.1f %10u %12lld%s", producerCount,
+                     locked ? "locked" : "lockfree", received / max(seconds, 1e-9),
+                     (double)depthTotal / max(batches, 1LL), maxDepth, ingestFullRetries.load(),
+                     received == records ? "" : "  (records lost)");
+            cout << line << endl;
+            if (received != records) return 1;
         }
     }
+    return 0;
+}
 
-    if (availableCount == 0) {
-        cout << "No available managers to export to." << endl;
-        return;
-    }
+// Near-duplicate detection. Each open case is signed with MINHASH_SIZE
+// MinHash values over the words of its title and description; two
+// signatures agree in a fraction of positions that estimates the Jaccard
+// similarity of the word sets. The signature is cut into LSH_BANDS bands,
+// and cases sharing any band are the only ones compared, so a lookup
+// costs the same whatever the store size.
+unsigned long long mixBits(unsigned long long x) {
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
 
-    cout << "Enter manager name to export to (or 'cancel' to abort): ";
-    string managerName;
-    getline(cin, managerName);
+// Hash k of a word is the top half of word * a[k] + b[k], a[k] odd
+const unsigned long long* minHashCoefficients() {
+    static unsigned long long coefficients[2 * MINHASH_SIZE];
+    static bool ready = [] {
+        for (int k = 0; k < 2 * MINHASH_SIZE; k++) coefficients[k] = mixBits(k + 1) | (k % 2 == 0 ? 1 : 0);
+        return true;
+    }();
+    (void)ready;
+    return coefficients;
+}
 
-    if (managerName == "cancel") {
-        cout << "Export cancelled." << endl;
-        return;
+// Folds the words of text (runs of letters and digits, case-insensitive)
+// into minHash; false when there were none
+bool addWordsToSignature(const char* text, size_t length, unsigned int* minHash) {
+    const unsigned long long* coefficients = minHashCoefficients();
+    bool any = false;
+    size_t i = 0;
+    while (true) {
+        while (i < length && !isalnum((unsigned char)text[i])) i++;
+        if (i == length) return any;
+        unsigned long long word = 14695981039346656037ULL;
+        for (; i < length && isalnum((unsigned char)text[i]); i++) {
+            word = (word ^ (unsigned char)tolower((unsigned char)text[i])) * 1099511628211ULL;
+        }
+        word = mixBits(word);
+        for (int k = 0; k < MINHASH_SIZE; k++) {
+            unsigned int h = (unsigned int)((word * coefficients[2 * k] + coefficients[2 * k + 1]) >> 32);
+            if (h < minHash[k]) minHash[k] = h;
+        }
+        any = true;
     }
+}
 
-    int managerIndex = findManagerIndex(managerName);
-    if (managerIndex == -1 || !managers[managerIndex].active) {
-        cout << "Invalid manager selection. Please choose from available managers." << endl;
-        return;
-    }
+// False when neither the title nor the description has a word to go on
+bool signCase(int caseId, const Text& title, const char* description, size_t length, CaseSignature& out) {
+    out.caseId = caseId;
+    fill(out.minHash, out.minHash + MINHASH_SIZE, 0xFFFFFFFFu);
+    bool titled = addWordsToSignature(title.chars, title.length(), out.minHash);
+    return addWordsToSignature(description, length, out.minHash) || titled;
+}
 
-    for (int i = 0; i < c.assignedManagerCount; i++) {
-        if (c.assignedManagers[i] == managerName) {
-            cout << "Case is already assigned to this manager." << endl;
-            return;
+double signatureSimilarity(const CaseSignature& a, const CaseSignature& b) {
+    int same = 0;
+    for (int k = 0; k < MINHASH_SIZE; k++) same += a.minHash[k] == b.minHash[k];
+    return (double)same / MINHASH_SIZE;
+}
+
+unsigned int bandKey(const CaseSignature& s, int band) {
+    const int rows = MINHASH_SIZE / LSH_BANDS;
+    unsigned long long key = band;
+    for (int r = 0; r < rows; r++) key = mixBits(key ^ s.minHash[band * rows + r]);
+    return (unsigned int)key;
+}
+
+// Adds the bands of s to bandTable. A band value already shared by
+// LSH_BUCKET_LIMIT cases is not added again: in an alert storm those
+// cases already find each other, and the probe run stays short.
+void insertBands(const CaseSignature& s) {
+    int mask = bandTableSize - 1;
+    for (int band = 0; band < LSH_BANDS; band++) {
+        unsigned int key = bandKey(s, band);
+        int h = (int)(key & mask);
+        int sharing = 0;
+        for (; bandTable[h].caseId != -1; h = (h + 1) & mask) {
+            if (bandTable[h].key == key) sharing++;
         }
+        if (sharing >= LSH_BUCKET_LIMIT) continue;
+        bandTable[h].key = key;
+        bandTable[h].caseId = s.caseId;
+        bandEntryCount++;
     }
+}
 
-    cout << "Enter reason for export: ";
-    string reason;
-    getline(cin, reason);
-    if (reason.empty()) {
-        reason = "No reason provided";
+// Re-creates bandTable from caseSignatures, which also drops the bands of
+// edited, closed and deleted cases
+void rebuildBandTable() {
+    int size = 64;
+    while (size < 4 * LSH_BANDS * (caseSignatures.size() + 1)) size *= 2;
+    if (size != bandTableSize) {
+        delete[] bandTable;
+        bandTable = new BandEntry[size];
+        bandTableSize = size;
     }
+    for (int i = 0; i < bandTableSize; i++) bandTable[i].caseId = -1;
+    bandEntryCount = 0;
+    for (int i = 0; i < caseSignatures.size(); i++) insertBands(caseSignatures[i]);
+}
 
-    cout << "You are about to export this case to " << managerName << endl;
-    cout << "Reason: " << reason << endl;
-    cout << "Are you sure you want to proceed? (y/n): ";
-    char confirm;
-    cin >> confirm;
-    clearInputBuffer();
-
-    if (tolower(confirm) != 'y') {
-        cout << "Export cancelled." << endl;
+// Indexes s, replacing any earlier signature of the same case
+void rememberCaseSignature(const CaseSignature& s) {
+    int position = caseSignatures.find(s.caseId);
+    if (position >= 0) {
+        caseSignatures[position] = s;
+    } else if (!caseSignatures.full()) {
+        caseSignatures.append(s);
+    } else {
         return;
     }
+    if (2 * (bandEntryCount + LSH_BANDS) > bandTableSize) {
+        rebuildBandTable();
+    } else {
+        insertBands(s);
+    }
+}
 
-    if (c.assignedManagerCount < MAX_ASSIGNED_MANAGERS) {
-        // Add manager to case
-        c.assignedManagers[c.assignedManagerCount++] = managerName;
+// Its bands stay in bandTable until the next rebuild; lookups skip them
+void forgetCaseSignature(int caseId) {
+    int position = caseSignatures.find(caseId);
+    if (position >= 0) caseSignatures.erase(position);
+}
 
-        // Log the export as an action
-        if (c.actionCount < MAX_ACTIONS) {
-            Action& action = c.actions[c.actionCount++];
-            action.description = "Case exported to " + managerName + ". Reason: " + reason;
-            action.date = getCurrentDate();
-            action.time = getCurrentTime();
-            action.manager = currentUser;
+// The older open case most similar to s, if any reaches
+// DUPLICATE_SIMILARITY. Safe to call from several threads while the index
+// is not being changed.
+DuplicateMatch findDuplicateCase(const CaseSignature& s) {
+    DuplicateMatch best;
+    best.caseId = s.caseId;
+    int mask = bandTableSize - 1;
+    for (int band = 0; band < LSH_BANDS && bandTableSize > 0; band++) {
+        unsigned int key = bandKey(s, band);
+        for (int h = (int)(key & mask); bandTable[h].caseId != -1; h = (h + 1) & mask) {
+            int candidate = bandTable[h].caseId;
+            if (bandTable[h].key != key || candidate >= s.caseId || candidate == best.duplicateOf) continue;
+            int position = caseSignatures.find(candidate);
+            if (position < 0) continue;
+            double similarity = signatureSimilarity(s, caseSignatures[position]);
+            if (similarity < DUPLICATE_SIMILARITY || similarity < best.similarity ||
+                (similarity == best.similarity && candidate > best.duplicateOf)) {
+                continue;
+            }
+            int caseIndex = findCaseIndex(candidate);
+            if (caseIndex == -1 || cases[caseIndex].status == "Closed") continue;
+            best.duplicateOf = candidate;
+            best.similarity = similarity;
         }
+    }
+    return best;
+}
 
-        // Update status if needed
-        c.status = "Exported";
-
-        cout << "Case successfully exported to " << managerName << endl;
-        cout << "Export details have been recorded." << endl;
-    } else {
-        cout << "Cannot export: Maximum managers already assigned to this case." << endl;
+// Reads the description of the record at offset in the data file
+bool recordDescription(istream& in, streamoff offset, string& description) {
+    in.clear();
+    in.seekg(offset);
+    thread_local string line;
+    for (int i = 0; i < 4 && readLine(in, line); i++) { // "Case ID:", then title and description
+        if (i > 0 && startsWith(line, "  Description: ")) {
+            description.assign(line, 15, string::npos);
+            return true;
+        }
     }
+    return false;
 }
 
+// Signs the open cases in [begin, end) into (*out)[begin, end); unsigned
+// slots get caseId -1. Descriptions not in memory are read from the data
+// file through this thread's own stream.
+void signCaseRange(int begin, int end, CaseList<CaseSignature>* out) {
+    ifstream dataFile;
+    string diskDescription;
+    for (int i = begin; i < end; i++) {
+        const Case& c = cases[i];
+        CaseSignature& s = (*out)[i];
+        s.caseId = -1;
+        if (c.status == "Closed") continue;
+        const char* description = "";
+        size_t length = 0;
+        if (c.bodyLoaded) {
+            description = c.description.chars ? c.description.chars : "";
+            length = c.description.length();
+        } else {
+            if (!dataFile.is_open()) dataFile.open(DATA_FILE, ios::binary);
+            if (c.recordOffset < 0 || !recordDescription(dataFile, c.recordOffset, diskDescription)) continue;
+            description = diskDescription.c_str();
+            length = diskDescription.length();
+        }
+        if (!signCase(c.id, c.title, description, length, s)) s.caseId = -1;
+    }
+}
 
-void closeCase() {
-    cout << "Enter Case ID: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
+// Signs every open case, on several threads for large stores, and indexes
+// the signatures. Returns the number of threads used.
+int buildDuplicateIndex() {
+    CaseList<CaseSignature> signatures;
+    for (int i = 0; i < cases.size(); i++) signatures.append();
+    int workers = (int)thread::hardware_concurrency();
+    workers = max(1, min(workers, min(MAX_DUPLICATE_WORKERS, (cases.size() + DUPLICATE_CASES_PER_WORKER - 1) /
+                                                            DUPLICATE_CASES_PER_WORKER)));
+    thread threads[MAX_DUPLICATE_WORKERS];
+    for (int w = 1; w < workers; w++) {
+        threads[w] = thread(signCaseRange, (int)((long long)cases.size() * w / workers),
+                            (int)((long long)cases.size() * (w + 1) / workers), &signatures);
+    }
+    signCaseRange(0, (int)((long long)cases.size() / workers), &signatures);
+    for (int w = 1; w < workers; w++) threads[w].join();
 
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
-        return;
+    caseSignatures.truncate(0);
+    for (int i = 0; i < cases.size(); i++) {
+        if (signatures[i].caseId != -1) caseSignatures.append(signatures[i]);
     }
+    rebuildBandTable();
+    return workers;
+}
 
-    Case& c = cases[caseIndex];
-    if (c.status == "Closed") {
-        cout << "Case is already closed." << endl;
-        return;
+// Finds, for each signature in [begin, end) of caseSignatures, the older
+// open case it most resembles
+void matchSignatureRange(int begin, int end, CaseList<DuplicateMatch>* out) {
+    for (int i = begin; i < end; i++) (*out)[i] = findDuplicateCase(caseSignatures[i]);
+}
+
+// --duplicates: a bulk pass over the open cases. Each case that looks like
+// a copy of an older one is listed with the oldest case of its group,
+// tab-separated: case, original, similarity to its closest older match,
+// title.
+int runDuplicateScan() {
+    streambuf* output = cout.rdbuf(cerr.rdbuf()); // Load messages go to stderr
+    loadData();
+    cout.rdbuf(output);
+
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    int workers = buildDuplicateIndex();
+    double signMs = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+
+    // Match on the same threads; the index is only read from here on
+    int count = caseSignatures.size();
+    CaseList<DuplicateMatch> matches;
+    for (int i = 0; i < count; i++) matches.append();
+    thread threads[MAX_DUPLICATE_WORKERS];
+    for (int w = 1; w < workers; w++) {
+        threads[w] = thread(matchSignatureRange, (int)((long long)count * w / workers),
+                            (int)((long long)count * (w + 1) / workers), &matches);
+    }
+    matchSignatureRange(0, count / workers, &matches);
+    for (int w = 1; w < workers; w++) threads[w].join();
+
+    // Each match points at an older case, so following them always ends at
+    // the oldest case of the group
+    int duplicates = 0;
+    int groups = 0;
+    CaseList<bool> grouped; // By position in caseSignatures: already counted as an original
+    for (int i = 0; i < count; i++) grouped.append() = false;
+    for (int i = 0; i < count; i++) {
+        if (matches[i].duplicateOf == -1) continue;
+        int original = matches[i].duplicateOf;
+        for (int position = caseSignatures.find(original); position >= 0 && matches[position].duplicateOf != -1;
+             position = caseSignatures.find(original)) {
+            original = matches[position].duplicateOf;
+        }
+        int caseIndex = findCaseIndex(matches[i].caseId);
+        char similarity[16];
+        snprintf(similarity, sizeof(similarity), "%.0f%%", 100 * matches[i].similarity);
+        cout << matches[i].caseId << '\t' << original << '\t' << similarity << '\t' << cases[caseIndex].title << '\n';
+        duplicates++;
+        int originalPosition = caseSignatures.find(original);
+        if (originalPosition >= 0 && !grouped[originalPosition]) {
+            grouped[originalPosition] = true;
+            groups++;
+        }
     }
+    cout.flush();
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    cerr << count << " open cases signed in " << signMs << " ms, " << duplicates << " likely duplicates in " << groups
+         << " groups, " << ms << " ms on " << workers << " thread" << (workers == 1 ? "" : "s") << endl;
+    return 0;
+}
 
-    c.status = "Closed";
-    cout << "Case closed successfully." << endl;
+// Shared-memory replica. The interactive thread publishes the store into
+// REPLICA_PREFIX + a hash of the working directory after each command that
+// changed something and after each save. The image is kept privately and
+// copied in under a sequence lock, so the writer never waits for readers;
+// a reader copies the image out and retries if the sequence moved
+// meanwhile.
+#if IE_POSIX
+string replicaName() {
+    char directory[4096];
+    if (getcwd(directory, sizeof(directory)) == nullptr) directory[0] = '\0';
+    char name[64];
+    snprintf(name, sizeof(name), "%s%08x", REPLICA_PREFIX, (unsigned int)hashKey(string(directory)));
+    return name;
 }
 
-void editCase() {
-    if (currentUserIsManager) {
-        cout << "Only admin can edit cases." << endl;
-        return;
+// Creates (replacing any left by a crashed run) a segment for an image of
+// up to capacity bytes
+bool createReplicaSegment(size_t capacity) {
+    string name = replicaName();
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0644);
+    if (fd < 0) return false;
+    size_t size = sizeof(ReplicaHeader) + capacity;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        shm_unlink(name.c_str());
+        return false;
+    }
+    struct stat info;
+    void* memory = fstat(fd, &info) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    close(fd);
+    if (memory == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return false;
     }
+    replicaInode = info.st_ino;
+    ReplicaHeader* header = new (memory) ReplicaHeader();
+    header->state.capacity = capacity;
+    header->state.writerPid = (int)getpid();
+    atomic_thread_fence(memory_order_release);
+    memcpy(header->magic, REPLICA_MAGIC, sizeof(header->magic)); // Readers wait for this
+    replicaHeader = header;
+    replicaSegmentSize = size;
+    return true;
+}
 
-    cout << "Enter Case ID: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
+// Removes the name only if it is still this process's segment, not one a
+// later run in the same directory has replaced it with
+void closeReplica() {
+    if (replicaHeader == nullptr) return;
+    munmap(replicaHeader, replicaSegmentSize);
+    replicaHeader = nullptr;
+    string name = replicaName();
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) return;
+    struct stat info;
+    if (fstat(fd, &info) == 0 && (unsigned long long)info.st_ino == replicaInode) shm_unlink(name.c_str());
+    close(fd);
+}
+#else
+bool createReplicaSegment(size_t) { return false; }
+void closeReplica() {}
+#endif
+
+// Appends a length-prefixed string to the image and returns its offset
+unsigned int appendReplicaString(string& image, const char* text, size_t length) {
+    unsigned int offset = (unsigned int)image.size();
+    unsigned int size = (unsigned int)length;
+    image.append((const char*)&size, 4);
+    image.append(text, length);
+    image.append((4 - length % 4) % 4, '\0'); // Keep later records aligned
+    return offset;
+}
 
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
-        return;
+unsigned int appendReplicaString(string& image, const string& text) {
+    return appendReplicaString(image, text.data(), text.size());
+}
+
+// Writes c's entry at offset at of replicaImage, appending its strings
+void writeReplicaCase(const Case& c, size_t at) {
+    string& image = replicaImage;
+    ReplicaCase r;
+    memset(&r, 0, sizeof(r));
+    r.id = c.id;
+    r.creationDate = c.creationDate.value;
+    r.creationTime = c.creationTime.value;
+    r.lastActionDate = c.lastActionDate.value;
+    r.modifiedSeq = c.modifiedSeq;
+    r.modifiedDate = c.modifiedDate.value;
+    r.modifiedTime = c.modifiedTime.value;
+    r.title = appendReplicaString(image, c.title.chars ? c.title.chars : "", c.title.length());
+    r.status = appendReplicaString(image, c.status.str());
+    r.source = appendReplicaString(image, c.source.str());
+    r.assignedManagerCount = c.assignedManagerCount;
+    unsigned int names[MAX_ASSIGNED_MANAGERS];
+    for (int j = 0; j < c.assignedManagerCount; j++) names[j] = appendReplicaString(image, c.assignedManagers[j].str());
+    r.assignedManagers = (unsigned int)image.size();
+    image.append((const char*)names, c.assignedManagerCount * sizeof(unsigned int));
+
+    // A body evicted with changes is only in the journal, which replicas
+    // do not read, so it goes into the image
+    const Case* body = &c;
+    Case journalCopy;
+    if (!c.bodyLoaded && c.journalOffset >= 0) {
+        ifstream journal(JOURNAL_FILE, ios::binary);
+        if (journal && readCaseRecord(journal, c.journalOffset, journalCopy) && journalCopy.id == c.id) {
+            body = &journalCopy;
+        } else {
+            cerr << "Error reading case " << c.id << " from " << JOURNAL_FILE << endl;
+        }
     }
+    r.actionCount = body->actionCount;
+    r.recordOffset = body->bodyLoaded ? -1 : (long long)c.recordOffset;
+    if (body->bodyLoaded) {
+        r.description = appendReplicaString(image, body->description.chars ? body->description.chars : "",
+                                            body->description.length());
+        ReplicaAction actions[MAX_ACTIONS];
+        for (int j = 0; j < body->actionCount; j++) {
+            const Action& a = body->actions[j];
+            actions[j].date = a.date.value;
+            actions[j].time = a.time.value;
+            actions[j].manager = appendReplicaString(image, a.manager.str());
+            actions[j].description = appendReplicaString(image, a.description.chars ? a.description.chars : "",
+                                                         a.description.length());
+        }
+        r.actions = (unsigned int)image.size();
+        image.append((const char*)actions, body->actionCount * sizeof(ReplicaAction));
+    }
+    memcpy(&image[at], &r, sizeof(r));
+}
 
-    Case& c = cases[caseIndex];
-    if (c.status == "Closed") {
-        cout << "Cannot edit closed case." << endl;
-        return;
+// Rewrites the manager table, moving it to the end of the image if the
+// managers have outgrown it
+void writeReplicaManagers() {
+    string& image = replicaImage;
+    if (managers.size() > replicaManagerCapacity) {
+        replicaManagerCapacity = 2 * managers.size();
+        replicaImageState.managerTable = image.size();
+        image.append(replicaManagerCapacity * sizeof(ReplicaManager), '\0');
+    }
+    for (int i = 0; i < managers.size(); i++) {
+        ReplicaManager m;
+        m.name = appendReplicaString(image, managers[i].name);
+        m.department = appendReplicaString(image, managers[i].department.str());
+        m.active = managers[i].active;
+        memcpy(&image[replicaImageState.managerTable + i * sizeof(ReplicaManager)], &m, sizeof(m));
     }
+    replicaImageState.managerCount = managers.size();
+}
 
-    cout << "Current title: " << c.title << endl;
-    cout << "Enter new title (or press Enter to keep current): ";
-    string newTitle;
-    getline(cin, newTitle);
-    if (!newTitle.empty()) {
-        c.title = newTitle;
+// Builds replicaImage from scratch, leaving room in the tables for the
+// store to grow a little before they have to move
+void buildReplicaImage() {
+    ReplicaState& state = replicaImageState;
+    replicaCaseCapacity = cases.size() + cases.size() / 4 + 16;
+    replicaManagerCapacity = 2 * managers.size() + 4;
+    state.caseTable = 0;
+    state.managerTable = replicaCaseCapacity * sizeof(ReplicaCase);
+    replicaImage.assign(state.managerTable + replicaManagerCapacity * sizeof(ReplicaManager), '\0');
+    for (int i = 0; i < cases.size(); i++) writeReplicaCase(cases[i], i * sizeof(ReplicaCase));
+    state.caseCount = cases.size();
+    writeReplicaManagers();
+    replicaRebuiltSize = replicaImage.size();
+    replicaDataHash = loadedDataHash;
+}
+
+// Brings replicaImage up to date by rewriting the entries of cases stamped
+// since the last publish and appending new ones; their old strings are
+// left behind as garbage. Adds what changed inside the published bytes to
+// patches, or sets patchCount past REPLICA_MAX_PATCHES when there is too
+// much to list. Returns false when only a rebuild will do: cases were
+// removed, a save moved the record offsets, or the garbage has grown as
+// large as the live image.
+bool patchReplicaImage(ReplicaPatch patches[], int& patchCount) {
+    ReplicaState& state = replicaImageState;
+    int known = state.caseCount;
+    if (replicaDataHash != loadedDataHash || cases.size() < known || replicaImage.size() > 2 * replicaRebuiltSize) {
+        return false;
+    }
+    if (known > 0) {
+        ReplicaCase last;
+        memcpy(&last, replicaImage.data() + state.caseTable + (known - 1) * sizeof(ReplicaCase), sizeof(last));
+        if (cases[known - 1].id != last.id) return false; // A case was removed and another added
     }
 
-    cout << "Current description: " << c.description << endl;
-    cout << "Enter new description (or press Enter to keep current): ";
-    string newDesc;
-    getline(cin, newDesc);
-    if (!newDesc.empty()) {
-        c.description = newDesc;
+    size_t published = replicaImage.size(); // Anything appended past this is copied anyway
+    int low = 0, high = modificationIndex.size();
+    while (low < high) {
+        int mid = low + (high - low) / 2;
+        if (modificationIndex[mid].seq <= replicaPublishedSeq) low = mid + 1; else high = mid;
+    }
+    for (int entry = low; entry < modificationIndex.size(); entry++) {
+        int index = findFirstCaseAfter(modificationIndex[entry].caseId - 1);
+        if (index >= known || cases[index].id != modificationIndex[entry].caseId ||
+            cases[index].modifiedSeq != modificationIndex[entry].seq) {
+            continue; // New (appended below), deleted, or stamped again later in the list
+        }
+        size_t at = state.caseTable + index * sizeof(ReplicaCase);
+        writeReplicaCase(cases[index], at);
+        if (patchCount < REPLICA_MAX_PATCHES) patches[patchCount] = { at, sizeof(ReplicaCase) };
+        patchCount++;
     }
 
-    cout << "Current source: " << c.source << endl;
-    cout << "Enter new source (or press Enter to keep current): ";
-    string newSource;
-    getline(cin, newSource);
-    if (!newSource.empty()) {
-        c.source = newSource;
+    if (cases.size() > replicaCaseCapacity) {
+        size_t table = replicaImage.size();
+        replicaCaseCapacity = cases.size() + cases.size() / 4 + 16;
+        replicaImage.append(replicaCaseCapacity * sizeof(ReplicaCase), '\0');
+        memcpy(&replicaImage[table], replicaImage.data() + state.caseTable, known * sizeof(ReplicaCase));
+        state.caseTable = table;
+    }
+    for (int i = known; i < cases.size(); i++) {
+        size_t at = state.caseTable + i * sizeof(ReplicaCase);
+        writeReplicaCase(cases[i], at);
+        if (at < published) {
+            if (patchCount < REPLICA_MAX_PATCHES) patches[patchCount] = { at, sizeof(ReplicaCase) };
+            patchCount++;
+        }
     }
+    state.caseCount = cases.size();
 
-    cout << "Case updated successfully." << endl;
+    bool managersChanged = managers.size() != state.managerCount;
+    for (int i = 0; i < managers.size() && !managersChanged; i++) {
+        managersChanged = managers[i].modifiedSeq > replicaPublishedSeq;
+    }
+    if (managersChanged) {
+        writeReplicaManagers();
+        if (state.managerTable < published) {
+            if (patchCount < REPLICA_MAX_PATCHES) {
+                patches[patchCount] = { (size_t)state.managerTable, managers.size() * sizeof(ReplicaManager) };
+            }
+            patchCount++;
+        }
+    }
+    return true;
 }
 
-void deleteCase() {
-    if (currentUserIsManager) {
-        cout << "Only admin can delete cases." << endl;
-        return;
+// Copies the store into the segment, moving to a larger segment first if
+// it has outgrown this one. Between saves only the records changed since
+// the last publish are rewritten and copied, so a command costs what it
+// changed rather than the size of the store.
+void publishReplica() {
+    if (replicaHeader == nullptr) return;
+    ReplicaPatch patches[REPLICA_MAX_PATCHES];
+    int patchCount = 0;
+    size_t published = replicaImage.size(); // Bytes the segment already matches, less the patches
+    if (replicaPublishedSeq < 0 || !patchReplicaImage(patches, patchCount)) {
+        buildReplicaImage();
+        published = 0;
     }
-
-    cout << "Enter Case ID to delete: ";
-    int caseId;
-    cin >> caseId;
-    clearInputBuffer();
-
-    int caseIndex = findCaseIndex(caseId);
-    if (caseIndex == -1) {
-        cout << "Case not found." << endl;
-        return;
+    const string& image = replicaImage;
+
+    ReplicaHeader* header = replicaHeader;
+    if (image.size() > header->state.capacity) {
+        unsigned int sequence = header->sequence.load(memory_order_relaxed);
+        header->sequence.store(sequence + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        header->state.retired = 1; // Readers reopen the name and find the new segment
+        header->sequence.store(sequence + 2, memory_order_release);
+#if IE_POSIX
+        munmap(header, replicaSegmentSize);
+#endif
+        replicaHeader = nullptr;
+        if (!createReplicaSegment(max<size_t>(2 * image.size(), REPLICA_MIN_CAPACITY))) {
+            cerr << "Cannot grow the shared-memory replica; it is no longer updated" << endl;
+            return;
+        }
+        header = replicaHeader;
+        published = 0;
     }
-
-    for (int i = caseIndex; i < caseCount - 1; i++) {
-        cases[i] = cases[i + 1];
+    if (patchCount > REPLICA_MAX_PATCHES) published = 0;
+
+    unsigned int sequence = header->sequence.load(memory_order_relaxed);
+    header->sequence.store(sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    char* target = (char*)(header + 1);
+    if (published > 0) {
+        for (int i = 0; i < patchCount; i++) {
+            memcpy(target + patches[i].offset, image.data() + patches[i].offset, patches[i].length);
+        }
     }
-    caseCount--;
+    memcpy(target + published, image.data() + published, image.size() - published);
+    header->state.imageSize = image.size();
+    header->state.dataFileSize = loadedDataSize;
+    header->state.changeSequence = changeSequence;
+    header->state.caseCount = replicaImageState.caseCount;
+    header->state.managerCount = replicaImageState.managerCount;
+    header->state.caseTable = replicaImageState.caseTable;
+    header->state.managerTable = replicaImageState.managerTable;
+    header->state.nextCaseId = nextCaseId;
+    header->sequence.store(sequence + 2, memory_order_release);
+    replicaPublishedSeq = changeSequence;
+}
 
-    cout << "Case deleted successfully." << endl;
+// Starts publishing; quietly does nothing where shared memory is missing
+void openReplica() {
+    if (createReplicaSegment(REPLICA_MIN_CAPACITY)) publishReplica();
 }
 
-void addManager() {
-    if (managerCount >= MAX_MANAGERS) {
-        cout << "Maximum number of managers reached." << endl;
-        return;
+// Attaches to the replica of the process running in this directory and
+// copies out a consistent image; false with a message if there is none
+bool readReplica(string& image, ReplicaState& state, string& error) {
+#if IE_POSIX
+    string name = replicaName();
+    error = "The replica kept changing while being read; try again";
+    for (int attempt = 0; attempt < REPLICA_READ_ATTEMPTS; attempt++) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            error = "No live replica for this directory (is the app running?)";
+            return false;
+        }
+        struct stat info;
+        void* memory = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && (size_t)info.st_size >= sizeof(ReplicaHeader)) {
+            memory = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+        if (memory == MAP_FAILED) {
+            this_thread::sleep_for(chrono::milliseconds(1)); // Still being created
+            continue;
+        }
+        const ReplicaHeader* shared = (const ReplicaHeader*)memory;
+        bool ready = memcmp(shared->magic, REPLICA_MAGIC, sizeof(shared->magic)) == 0;
+        atomic_thread_fence(memory_order_acquire);
+        bool consistent = false;
+        bool valid = false;
+        for (int spin = 0; ready && spin < REPLICA_READ_ATTEMPTS && !consistent; spin++) {
+            unsigned int before = shared->sequence.load(memory_order_acquire);
+            if (before % 2 == 1) {
+                this_thread::yield();
+                continue;
+            }
+            state = shared->state;
+            valid = state.imageSize <= state.capacity && sizeof(ReplicaHeader) + state.capacity <= (size_t)info.st_size &&
+                    state.caseCount >= 0 && state.managerCount >= 0 &&
+                    state.caseTable + (unsigned long long)state.caseCount * sizeof(ReplicaCase) <= state.imageSize &&
+                    state.managerTable + (unsigned long long)state.managerCount * sizeof(ReplicaManager) <= state.imageSize;
+            if (valid) image.assign((const char*)(shared + 1), state.imageSize);
+            atomic_thread_fence(memory_order_acquire);
+            consistent = shared->sequence.load(memory_order_relaxed) == before;
+        }
+        munmap(memory, info.st_size);
+        if (!ready || (consistent && state.retired)) {
+            this_thread::sleep_for(chrono::milliseconds(1)); // Being created or replaced
+            continue;
+        }
+        if (!consistent) return false;
+        if (!valid) {
+            error = "The replica segment is damaged";
+            return false;
+        }
+        if (kill(state.writerPid, 0) != 0 && errno == ESRCH) {
+            cerr << "Warning: process " << state.writerPid << ", which published this replica, has exited" << endl;
+        }
+        return true;
     }
+    return false;
+#else
+    (void)image;
+    (void)state;
+    error = "Shared-memory replicas need a POSIX system";
+    return false;
+#endif
+}
 
-    Manager& m = managers[managerCount++];
-    cout << "Enter manager name: ";
-    getline(cin, m.name);
-    cout << "Enter department: ";
-    getline(cin, m.department);
-    cout << "Set password: ";
-    getline(cin, m.password);
-    m.active = true;
+const char* replicaString(const string& image, unsigned int offset, size_t& length) {
+    unsigned int size = 0;
+    if ((size_t)offset + 4 <= image.size()) memcpy(&size, image.data() + offset, 4);
+    if ((size_t)offset + 4 + size > image.size()) size = 0; // Damaged offsets read as empty
+    length = size;
+    return image.data() + min<size_t>((size_t)offset + 4, image.size());
+}
 
-    cout << "Manager added successfully." << endl;
+string replicaString(const string& image, unsigned int offset) {
+    size_t length;
+    const char* text = replicaString(image, offset, length);
+    return string(text, length);
 }
 
-void viewManagers() {
-    if (managerCount == 0) {
-        cout << "No managers found." << endl;
-        return;
+// Replaces the store with the cases and managers of a replica image; bodies
+// not in the image keep their DATA_FILE offsets
+void loadReplicaImage(const string& image, const ReplicaState& state) {
+    cases.truncate(0);
+    managers.truncate(0);
+    size_t length;
+    for (int i = 0; i < state.caseCount && !cases.full(); i++) {
+        ReplicaCase r;
+        memcpy(&r, image.data() + state.caseTable + i * sizeof(ReplicaCase), sizeof(r));
+        Case c;
+        c.id = r.id;
+        c.creationDate.value = r.creationDate;
+        c.creationTime.value = r.creationTime;
+        c.lastActionDate.value = r.lastActionDate;
+        c.modifiedSeq = r.modifiedSeq;
+        c.modifiedDate.value = r.modifiedDate;
+        c.modifiedTime.value = r.modifiedTime;
+        const char* text = replicaString(image, r.title, length);
+        c.title.assign(text, length);
+        c.status = replicaString(image, r.status);
+        c.source = replicaString(image, r.source);
+        c.assignedManagerCount = min(r.assignedManagerCount, MAX_ASSIGNED_MANAGERS);
+        for (int j = 0; j < c.assignedManagerCount; j++) {
+            unsigned int name;
+            memcpy(&name, image.data() + r.assignedManagers + j * sizeof(unsigned int), sizeof(name));
+            c.assignedManagers[j] = replicaString(image, name);
+        }
+        c.actionCount = min(r.actionCount, MAX_ACTIONS);
+        c.recordOffset = r.recordOffset;
+        c.bodyLoaded = r.recordOffset < 0;
+        if (c.bodyLoaded) {
+            text = replicaString(image, r.description, length);
+            c.description.assign(text, length);
+            for (int j = 0; j < c.actionCount; j++) {
+                ReplicaAction a;
+                memcpy(&a, image.data() + r.actions + j * sizeof(ReplicaAction), sizeof(a));
+                c.actions[j].date.value = a.date;
+                c.actions[j].time.value = a.time;
+                c.actions[j].manager = replicaString(image, a.manager);
+                text = replicaString(image, a.description, length);
+                c.actions[j].description.assign(text, length);
+            }
+        }
+        cases.append(c);
     }
+    for (int i = 0; i < state.managerCount && !managers.full(); i++) {
+        ReplicaManager r;
+        memcpy(&r, image.data() + state.managerTable + i * sizeof(ReplicaManager), sizeof(r));
+        Manager m;
+        m.name = replicaString(image, r.name);
+        m.department = replicaString(image, r.department);
+        m.active = r.active != 0;
+        managers.append(m);
+    }
+    nextCaseId = state.nextCaseId;
+    changeSequence = state.changeSequence;
+}
 
-    cout << "\n=== Manager List ===" << endl;
-    for (int i = 0; i < managerCount; i++) {
-        cout << "Name: " << managers[i].name << endl;
-        cout << "Department: " << managers[i].department << endl;
-        cout << "Status: " << (managers[i].active ? "Active" : "Inactive") << endl;
-        cout << "---------------------" << endl;
+// --report-from-shm <text|json|csv> [fields] [file]: --report over the live
+// replica instead of DATA_FILE. Bodies the app had not loaded are read from
+// DATA_FILE, so the replica is read again if a save replaced the file since.
+int runReplicaReport(const string& format, const string& fields, const string& target) {
+    ReportOptions options;
+    string error;
+    if (!parseReportOptions(format, fields, options, error)) {
+        cerr << error << endl;
+        return 2;
     }
+    options.target = target.empty() ? "-" : target;
+
+    chrono::steady_clock::time_point started = chrono::steady_clock::now();
+    string image;
+    ReplicaState state;
+    for (int attempt = 0; ; attempt++) {
+        if (!readReplica(image, state, error)) {
+            cerr << error << endl;
+            return 1;
+        }
+        if (!options.needsBody) break;
+        ifstream dataFile(DATA_FILE, ios::binary | ios::ate);
+        unsigned long long dataSize = dataFile ? (unsigned long long)dataFile.tellg() : 0; // None before the first save
+        if (dataSize == state.dataFileSize) break;
+        if (attempt == REPLICA_READ_ATTEMPTS) {
+            cerr << DATA_FILE << " does not match the replica; try again" << endl;
+            return 1;
+        }
+        this_thread::sleep_for(chrono::milliseconds(10)); // A save is being published
+    }
+    loadReplicaImage(image, state);
+    double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - started).count();
+    cerr << "Replica at change " << state.changeSequence << ": " << cases.size() << " cases, " << image.size()
+         << " bytes, attached in " << ms << " ms" << endl;
+    return runReport(takeSnapshot(), options) ? 0 : 1;
 }
 
-void editManager() {
-    cout << "Enter manager name to edit: ";
-    string name;
-    getline(cin, name);
+// Edit history. editCase appends a revision to HISTORY_FILE for every edit
+// that changed something; openHistory indexes the file at startup. Queries
+// find a revision in the index and read only the lines back to its
+// checkpoint.
+void writeHistoryText(string& out, const string& text) {
+    out += to_string(text.size());
+    out += ':';
+    out += text;
+}
 
-    int index = findManagerIndex(name);
-    if (index == -1) {
-        cout << "Manager not found." << endl;
-        return;
-    }
+bool readHistoryText(istream& in, string& text) {
+    size_t length;
+    if (!(in >> length) || in.get() != ':' || length > (1u << 24)) return false; // Torn lines read as damaged
+    text.resize(length);
+    return length == 0 || in.read(&text[0], length);
+}
 
-    Manager& m = managers[index];
-    cout << "Current department: " << m.department << endl;
-    cout << "Enter new department (or press Enter to keep current): ";
-    string newDept;
-    getline(cin, newDept);
-    if (!newDept.empty()) {
-        m.department = newDept;
+// "caseId number seq date time C|D author" and the three fields, each a
+// "length:bytes" string; delta fields are "-" or "prefix suffix length:bytes"
+string formatRevision(const Revision& r) {
+    string line = to_string(r.caseId) + ' ' + to_string(r.number) + ' ' + to_string(r.seq) + ' ' +
+                  to_string(r.date.value) + ' ' + to_string(r.time.value) + (r.checkpoint ? " C " : " D ");
+    writeHistoryText(line, r.author);
+    for (int f = 0; f < HISTORY_FIELDS; f++) {
+        const FieldChange& change = r.fields[f];
+        line += ' ';
+        if (!r.checkpoint) {
+            if (change.prefix < 0) {
+                line += '-';
+                continue;
+            }
+            line += to_string(change.prefix) + ' ' + to_string(change.suffix) + ' ';
+        }
+        writeHistoryText(line, change.text);
     }
-
-    cout << "Manager updated successfully." << endl;
+    line += '\n';
+    return line;
 }
 
-void toggleManagerStatus() {
-    cout << "Enter manager name to toggle status: ";
-    string name;
-    getline(cin, name);
+bool readRevision(istream& in, Revision& r) {
+    char kind;
+    if (!(in >> r.caseId >> r.number >> r.seq >> r.date.value >> r.time.value >> kind)) return false;
+    if ((kind != 'C' && kind != 'D') || in.get() != ' ' || !readHistoryText(in, r.author)) return false;
+    r.checkpoint = kind == 'C';
+    for (int f = 0; f < HISTORY_FIELDS; f++) {
+        FieldChange& change = r.fields[f];
+        change.prefix = change.suffix = 0;
+        if (in.get() != ' ') return false;
+        if (!r.checkpoint && in.peek() == '-') {
+            in.get();
+            change.prefix = -1;
+            change.text.clear();
+            continue;
+        }
+        if (!r.checkpoint && (!(in >> change.prefix >> change.suffix) || in.get() != ' ')) return false;
+        if (change.prefix < 0 || change.suffix < 0 || !readHistoryText(in, change.text)) return false;
+    }
+    return in.get() == '\n';
+}
 
-    int index = findManagerIndex(name);
-    if (index == -1) {
-        cout << "Manager not found." << endl;
+// The change that turns before into after: what they share at either end
+// is kept, the rest of after is stored
+void diffField(const string& before, const string& after, FieldChange& change) {
+    if (before == after) {
+        change.prefix = -1;
+        change.text.clear();
         return;
     }
+    size_t shorter = min(before.size(), after.size());
+    size_t prefix = 0;
+    while (prefix < shorter && before[prefix] == after[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < shorter - prefix && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) suffix++;
+    change.prefix = (int)prefix;
+    change.suffix = (int)suffix;
+    change.text = after.substr(prefix, after.size() - prefix - suffix);
+}
 
-    managers[index].active = !managers[index].active;
-    cout << "Manager status updated to: " << (managers[index].active ? "Active" : "Inactive") << endl;
+bool applyFieldChange(string& value, const FieldChange& change) {
+    if (change.prefix < 0) return true;
+    if ((size_t)change.prefix + change.suffix > value.size()) return false;
+    value = value.substr(0, change.prefix) + change.text + value.substr(value.size() - change.suffix);
+    return true;
 }
 
-void deleteManager() {
-    if (currentUserIsManager) {
-        cout << "Only admin can delete managers." << endl;
-        return;
+// Adds a revision read or written at offset to the index; false if it does
+// not follow the case's last indexed revision
+bool indexRevision(const Revision& r, streamoff offset) {
+    int head = historyHeads.find(r.caseId);
+    int previous = head < 0 ? -1 : historyHeads[head].latest;
+    int expected = previous < 0 ? 0 : historyEntries[previous].number + 1;
+    if (r.number != expected || (previous < 0 && !r.checkpoint)) return false;
+    HistoryEntry& e = historyEntries.append();
+    e.caseId = r.caseId;
+    e.number = r.number;
+    e.date = r.date;
+    e.time = r.time;
+    e.checkpoint = r.checkpoint;
+    e.offset = offset;
+    e.previous = previous;
+    if (head < 0) {
+        HistoryHead h;
+        h.caseId = r.caseId;
+        h.latest = historyEntries.size() - 1;
+        historyHeads.append(h);
+    } else {
+        historyHeads[head].latest = historyEntries.size() - 1;
     }
+    return true;
+}
 
-    if (managerCount <= 0) {
-        cout << "No managers to delete." << endl;
-        return;
+// Indexes HISTORY_FILE, cutting off a line left half-written by a crash
+void openHistory() {
+    historyEntries.truncate(0);
+    historyHeads.truncate(0);
+    historyFileSize = 0;
+    string contents;
+    if (!readWholeFile(HISTORY_FILE, contents)) return;
+    MemoryBuffer buffer(contents.data(), contents.size());
+    istream in(&buffer);
+    Revision r;
+    int unchained = 0;
+    while (readRevision(in, r)) {
+        if (!indexRevision(r, historyFileSize)) unchained++;
+        historyFileSize = in.tellg();
     }
+    if (unchained > 0) {
+        cout << unchained << " revisions in " << HISTORY_FILE << " are out of sequence and were skipped." << endl;
+    }
+    if (historyFileSize == (streamoff)contents.size()) return;
 
-    cout << "Enter manager name to delete: ";
-    string name;
-    getline(cin, name);
+    string kept = contents.substr(0, historyFileSize);
+    const string* parts[] = { &kept };
+    string tempFile = HISTORY_FILE + ".tmp";
+    if (writeFileDurably(tempFile, parts, 1) && rename(tempFile.c_str(), HISTORY_FILE.c_str()) == 0) {
+        cout << "Dropped an incomplete revision at the end of " << HISTORY_FILE << "." << endl;
+    } else {
+        remove(tempFile.c_str());
+        cerr << "Could not repair " << HISTORY_FILE << "; edits will not be recorded." << endl;
+        historyFileSize = -1;
+    }
+}
 
-    int index = findManagerIndex(name);
-    if (index == -1) {
-        cout << "Manager not found." << endl;
-        return;
+bool appendRevision(const Revision& r) {
+    if (historyFileSize < 0) return false;
+    string line = formatRevision(r);
+    ofstream out(HISTORY_FILE, ios::binary | ios::app);
+    out.write(line.data(), line.size());
+    out.flush();
+    if (!out) {
+        cerr << "Could not write " << HISTORY_FILE << "; this edit is not in the case history." << endl;
+        out.close();
+        openHistory(); // Drops whatever part of the line was written
+        return false;
     }
+    indexRevision(r, historyFileSize);
+    historyFileSize += line.size();
+    return true;
+}
 
-    for (int i = 0; i < caseCount; i++) {
-        for (int j = 0; j < cases[i].assignedManagerCount; j++) {
-            if (cases[i].assignedManagers[j] == name) {
-                cout << "Cannot delete manager. They are assigned to case ID: " 
-                     << cases[i].id << endl;
-                return;
-            }
+// Rebuilds a revision's fields from its checkpoint and the deltas after it;
+// last gets the revision's own line
+bool rebuildRevision(int entry, string values[HISTORY_FIELDS], Revision& last) {
+    int chain[HISTORY_CHECKPOINT_INTERVAL];
+    int length = 0;
+    for (int i = entry; ; i = historyEntries[i].previous) {
+        if (i < 0 || length == HISTORY_CHECKPOINT_INTERVAL) return false;
+        chain[length++] = i;
+        if (historyEntries[i].checkpoint) break;
+    }
+    ifstream in(HISTORY_FILE, ios::binary);
+    for (int k = length - 1; k >= 0; k--) {
+        const HistoryEntry& e = historyEntries[chain[k]];
+        in.seekg(e.offset);
+        if (!readRevision(in, last) || last.caseId != e.caseId || last.number != e.number) return false;
+        for (int f = 0; f < HISTORY_FIELDS; f++) {
+            if (!applyFieldChange(values[f], last.fields[f])) return false;
         }
     }
+    return true;
+}
 
-    for (int i = index; i < managerCount - 1; i++) {
-        managers[i] = managers[i + 1];
+// Records c's edit. before holds its fields as they were; the case's first
+// recorded edit also writes them as revision 0, dated at creation.
+void recordCaseEdit(const Case& c, const string before[HISTORY_FIELDS]) {
+    string after[HISTORY_FIELDS] = { c.title.str(), c.description.str(), c.source.str() };
+    bool changed = false;
+    for (int f = 0; f < HISTORY_FIELDS; f++) changed = changed || after[f] != before[f];
+    if (!changed) return;
+
+    Revision r;
+    r.caseId = c.id;
+    bool delta = true;
+    int head = historyHeads.find(c.id);
+    if (head < 0) {
+        r.date = c.creationDate;
+        r.time = c.creationTime;
+        r.checkpoint = true;
+        for (int f = 0; f < HISTORY_FIELDS; f++) r.fields[f].text = before[f];
+        if (!appendRevision(r)) return;
+        r.number = 1;
+    } else {
+        // An edit lost in a crash after its revision was written leaves the
+        // history ahead of the case; the next revision is then a checkpoint
+        int latest = historyHeads[head].latest;
+        string previous[HISTORY_FIELDS];
+        Revision line;
+        delta = rebuildRevision(latest, previous, line);
+        for (int f = 0; f < HISTORY_FIELDS; f++) delta = delta && previous[f] == before[f];
+        r.number = historyEntries[latest].number + 1;
     }
-    managerCount--;
 
-    cout << "Manager deleted successfully." << endl;
+    r.seq = c.modifiedSeq;
+    r.date = c.modifiedDate;
+    r.time = c.modifiedTime;
+    r.author = currentUser;
+    size_t full = 0, stored = 0;
+    for (int f = 0; f < HISTORY_FIELDS; f++) {
+        diffField(before[f], after[f], r.fields[f]);
+        full += after[f].size();
+        stored += r.fields[f].text.size();
+    }
+    r.checkpoint = !delta || r.number % HISTORY_CHECKPOINT_INTERVAL == 0 || stored >= full;
+    if (r.checkpoint) {
+        for (int f = 0; f < HISTORY_FIELDS; f++) {
+            r.fields[f].prefix = r.fields[f].suffix = 0;
+            r.fields[f].text = after[f];
+        }
+    }
+    appendRevision(r);
 }
 
-void generateReport() {
-    if (caseCount == 0) {
-        cout << "No cases to report." << endl;
-        return;
+// Revision of a case by number, or -1
+int findRevision(int caseId, int number) {
+    int head = historyHeads.find(caseId);
+    for (int i = head < 0 ? -1 : historyHeads[head].latest; i >= 0; i = historyEntries[i].previous) {
+        if (historyEntries[i].number == number) return i;
     }
+    return -1;
+}
 
-    string filename = "case_report_" + getCurrentDate() + ".txt";
-    ofstream report(filename);
-
-    if (!report) {
-        cerr << "Error creating report file!" << endl;
-        return;
+// Newest revision of a case made at or before date and time, or -1
+int findRevisionAsOf(int caseId, PackedDate date, PackedTime time) {
+    int head = historyHeads.find(caseId);
+    for (int i = head < 0 ? -1 : historyHeads[head].latest; i >= 0; i = historyEntries[i].previous) {
+        const HistoryEntry& e = historyEntries[i];
+        if (e.date.value < date.value || (e.date.value == date.value && e.time.value <= time.value)) return i;
     }
+    return -1;
+}
 
-    report << "=== Case Management System Report ===" << endl;
-    report << "Generated on: " << getCurrentDate() << " at " << getCurrentTime() << endl;
-    report << "Total cases: " << caseCount << endl << endl;
+// The case's current title, description and source, from the store or the
+// archive; false if there is no such case
+bool currentCaseFields(int caseId, string values[HISTORY_FIELDS], Case& summary) {
+    int caseIndex = findCaseIndex(caseId);
+    if (caseIndex >= 0) {
+        if (!loadCaseBody(cases[caseIndex])) return false;
+        summary = cases[caseIndex];
+    } else if (!findArchivedCase(caseId, summary)) {
+        return false;
+    }
+    values[HISTORY_TITLE] = summary.title.str();
+    values[HISTORY_DESCRIPTION] = summary.description.str();
+    values[HISTORY_SOURCE] = summary.source.str();
+    return true;
+}
 
-    for (int i = 0; i < caseCount; i++) {
-        Case& c = cases[i];
-        report << "Case ID: " << c.id << endl;
-        report << "Title: " << c.title << endl;
-        report << "Status: " << c.status << endl;
-        report << "Created: " << c.creationDate << endl;
-        report << "Assigned Managers: ";
-        for (int j = 0; j < c.assignedManagerCount; j++) {
-            report << c.assignedManagers[j];
-            if (j < c.assignedManagerCount - 1) report << ", ";
-        }
-        report << endl;
-        report << "Action Count: " << c.actionCount << endl;
-        report << "------------------------" << endl;
+// YYYY-MM-DD (the end of that day) or YYYY-MM-DD HH:MM:SS, with a space or T
+bool parseHistoryTime(const string& text, PackedDate& date, PackedTime& time) {
+    date = PackedDate(text.substr(0, 10));
+    if (date.empty()) return false;
+    if (text.size() == 10) {
+        time.value = 24 * 60 * 60 - 1;
+        return true;
     }
+    if (text[10] != ' ' && text[10] != 'T') return false;
+    time = PackedTime(text.substr(11));
+    return !time.empty();
+}
 
-    report.close();
-    cout << "Report generated: " << filename << endl;
+void printHistoryFields(const string values[HISTORY_FIELDS]) {
+    cout << "Title: " << values[HISTORY_TITLE] << endl;
+    cout << "Description: " << values[HISTORY_DESCRIPTION] << endl;
+    cout << "Source: " << values[HISTORY_SOURCE] << endl;
 }
 
-void saveData() {
-    ofstream outFile(DATA_FILE);
-    if (!outFile) {
-        cerr << "Error opening file for writing!" << endl;
-        return;
+// Lists a case's revisions oldest first with the fields each one changed
+bool printCaseHistory(int caseId) {
+    int head = historyHeads.find(caseId);
+    if (head < 0) {
+        string values[HISTORY_FIELDS];
+        Case summary;
+        if (!currentCaseFields(caseId, values, summary)) {
+            cout << "Case not found." << endl;
+            return false;
+        }
+        cout << "No edits recorded for case " << caseId << "; it is as created on " << summary.creationDate
+             << " at " << summary.creationTime << "." << endl;
+        return true;
     }
 
-    // Save managers with proper formatting
-    outFile << "=== MANAGERS ===" << endl;
-    for (int i = 0; i < managerCount; i++) {
-        outFile << "Manager " << (i+1) << ":" << endl;
-        outFile << "  Name: " << managers[i].name << endl;
-        outFile << "  Department: " << managers[i].department << endl;
-        outFile << "  Password: " << managers[i].password << endl;
-        outFile << "  Status: " << (managers[i].active ? "Active" : "Inactive") << endl;
-        outFile << endl; // Blank line between managers
+    HeapStorage::List<int> chain;
+    for (int i = historyHeads[head].latest; i >= 0; i = historyEntries[i].previous) chain.append() = i;
+    static const char* const FIELD_NAMES[] = { "title", "description", "source" };
+    cout << "\nHistory of case " << caseId << " (" << chain.size() << " revisions):" << endl;
+    cout << "Rev\tDate\t\tTime\t\tBy\tChanged" << endl;
+    ifstream in(HISTORY_FILE, ios::binary);
+    string values[HISTORY_FIELDS];
+    Revision r;
+    for (int k = chain.size() - 1; k >= 0; k--) {
+        const HistoryEntry& e = historyEntries[chain[k]];
+        in.seekg(e.offset);
+        if (!readRevision(in, r) || r.caseId != caseId || r.number != e.number) {
+            cout << HISTORY_FILE << " is damaged at revision " << e.number << "." << endl;
+            return false;
+        }
+        string changed;
+        for (int f = 0; f < HISTORY_FIELDS; f++) {
+            string before = values[f];
+            if (!applyFieldChange(values[f], r.fields[f])) {
+                cout << HISTORY_FILE << " is damaged at revision " << e.number << "." << endl;
+                return false;
+            }
+            if (r.number > 0 && values[f] != before) changed += string(changed.empty() ? "" : ", ") + FIELD_NAMES[f];
+        }
+        if (r.number == 0) changed = "(as created)";
+        cout << r.number << "\t" << r.date << "\t" << r.time << "\t" << (r.author.empty() ? "-" : r.author) << "\t"
+             << (changed.empty() ? "(nothing)" : changed) << endl;
     }
+    return true;
+}
 
-    // Save cases with proper formatting
-    outFile << "=== CASES ===" << endl;
-    for (int i = 0; i < caseCount; i++) {
-        Case& c = cases[i];
-        outFile << "Case ID: " << c.id << endl;
-        outFile << "  Title: " << c.title << endl;
-        outFile << "  Description: " << c.description << endl;
-        outFile << "  Created: " << c.creationDate << " at " << c.creationTime << endl;
-        outFile << "  Source: " << c.source << endl;
-        outFile << "  Status: " << c.status << endl;
-        
-        // Save assigned managers
-        outFile << "  Assigned Managers (" << c.assignedManagerCount << "):" << endl;
-        for (int j = 0; j < c.assignedManagerCount; j++) {
-            outFile << "    - " << c.assignedManagers[j] << endl;
+bool printCaseAsOf(int caseId, PackedDate date, PackedTime time) {
+    string values[HISTORY_FIELDS];
+    if (historyHeads.find(caseId) < 0) {
+        Case summary;
+        if (!currentCaseFields(caseId, values, summary)) {
+            cout << "Case not found." << endl;
+            return false;
         }
-        
-        // Save actions
-        outFile << "  Actions (" << c.actionCount << "):" << endl;
-        for (int j = 0; j < c.actionCount; j++) {
-            outFile << "    - " << c.actions[j].date << " " << c.actions[j].time 
-                   << " by " << c.actions[j].manager << ": " 
-                   << c.actions[j].description << endl;
+        if (summary.creationDate.value > date.value ||
+            (summary.creationDate.value == date.value && summary.creationTime.value > time.value)) {
+            cout << "Case " << caseId << " was created after " << date << " " << time << "." << endl;
+            return false;
         }
-        outFile << endl; // Blank line between cases
+        cout << "\nCase " << caseId << " as of " << date << " " << time << " (never edited):" << endl;
+        printHistoryFields(values);
+        return true;
     }
 
-    // Save system information
-    outFile << "=== SYSTEM ===" << endl;
-    outFile << "Next Case ID: " << nextCaseId << endl;
+    int entry = findRevisionAsOf(caseId, date, time);
+    if (entry < 0) {
+        cout << "Case " << caseId << " was created after " << date << " " << time << "." << endl;
+        return false;
+    }
+    Revision r;
+    if (!rebuildRevision(entry, values, r)) {
+        cout << HISTORY_FILE << " is damaged; case " << caseId << " cannot be rebuilt." << endl;
+        return false;
+    }
+    cout << "\nCase " << caseId << " as of " << date << " " << time << " (revision " << r.number;
+    if (r.number > 0) cout << ", edited by " << r.author << " on " << r.date << " at " << r.time;
+    cout << "):" << endl;
+    printHistoryFields(values);
+    return true;
+}
 
-    outFile.close();
-    cout << "Data saved successfully with improved formatting." << endl;
+bool printRevisionDiff(int caseId, int from, int to) {
+    int entries[2] = { findRevision(caseId, from), findRevision(caseId, to) };
+    string values[2][HISTORY_FIELDS];
+    Revision r[2];
+    for (int k = 0; k < 2; k++) {
+        if (entries[k] < 0) {
+            cout << "Case " << caseId << " has no revision " << (k == 0 ? from : to) << "." << endl;
+            return false;
+        }
+        if (!rebuildRevision(entries[k], values[k], r[k])) {
+            cout << HISTORY_FILE << " is damaged; case " << caseId << " cannot be rebuilt." << endl;
+            return false;
+        }
+    }
+    static const char* const FIELD_LABELS[] = { "Title", "Description", "Source" };
+    cout << "\nCase " << caseId << ", revision " << from << " (" << r[0].date << " " << r[0].time << ") to "
+         << to << " (" << r[1].date << " " << r[1].time << "):" << endl;
+    bool same = true;
+    for (int f = 0; f < HISTORY_FIELDS; f++) {
+        if (values[0][f] == values[1][f]) continue;
+        same = false;
+        cout << FIELD_LABELS[f] << ":" << endl;
+        cout << "- " << values[0][f] << endl;
+        cout << "+ " << values[1][f] << endl;
+    }
+    if (same) cout << "No differences." << endl;
+    return true;
 }
 
-void loadData() {
-    ifstream inFile(DATA_FILE);
-    if (!inFile) {
-        cout << "No existing data file found. Starting with empty database." << endl;
+void caseHistoryMenu() {
+    if (currentUserIsManager) {
+        cout << "Only admin can view case history." << endl;
         return;
     }
+    cout << "Enter Case ID: ";
+    int caseId;
+    cin >> caseId;
+    clearInputBuffer();
+    if (!printCaseHistory(caseId)) return;
 
+    cout << "Enter a date (YYYY-MM-DD [HH:MM:SS]) to see the case as of then, two revisions to compare,"
+         << " or press Enter to go back: ";
     string line;
-    string currentSection;
-    managerCount = 0;
-    caseCount = 0;
-    nextCaseId = 1000;
+    getline(cin, line);
+    if (line.empty()) return;
+    PackedDate date;
+    PackedTime time;
+    int from, to;
+    if (parseHistoryTime(line, date, time)) {
+        printCaseAsOf(caseId, date, time);
+    } else if (sscanf(line.c_str(), "%d %d", &from, &to) == 2) {
+        printRevisionDiff(caseId, from, to);
+    } else {
+        cout << "Invalid input." << endl;
+    }
+}
 
-    while (getline(inFile, line)) {
-        if (line.empty() || line[0] == '#') continue; // Skip blank lines or comments
+// --history <case ID> [YYYY-MM-DD [HH:MM:SS] | <revision> <revision>]
+int runHistoryCommand(int argCount, char* args[]) {
+    streambuf* output = cout.rdbuf(cerr.rdbuf());
+    loadData();
+    openHistory();
+    cout.rdbuf(output);
+    int caseId = atoi(args[0]);
+    if (argCount == 1) return printCaseHistory(caseId) ? 0 : 1;
+    string when = args[1];
+    if (argCount > 2) when += string(" ") + args[2];
+    PackedDate date;
+    PackedTime time;
+    if (argCount <= 3 && parseHistoryTime(when, date, time)) return printCaseAsOf(caseId, date, time) ? 0 : 1;
+    if (argCount == 3) return printRevisionDiff(caseId, atoi(args[1]), atoi(args[2])) ? 0 : 1;
+    cerr << "Usage: --history <case ID> [YYYY-MM-DD [HH:MM:SS] | <revision> <revision>]" << endl;
+    return 2;
+}
 
-        // Detect section headers in the data file
-        if (line.find("=== MANAGERS ===") != string::npos) {
-            currentSection = "managers";
-            continue;
-        } else if (line.find("=== CASES ===") != string::npos) {
-            currentSection = "cases";
-            continue;
-        } else if (line.find("=== SYSTEM ===") != string::npos) {
-            currentSection = "system";
-            continue;
-        }
+// Applies complete journal batches left by a session that did not reach
+// saveData. Replayed records stay dirty so the next save includes them.
+void replayJournal() {
+    ifstream journal(JOURNAL_FILE);
+    if (!journal) return;
 
-        // Parse data based on current section
-        if (currentSection == "managers" && managerCount < MAX_MANAGERS) {
-            if (line.find("Manager ") == 0) {
-                continue; // Marker line; actual data comes in next few lines
-            } else if (line.find("  Name: ") == 0) {
-                managers[managerCount].name = line.substr(8);
-            } else if (line.find("  Department: ") == 0) {
-                managers[managerCount].department = line.substr(14);
-            } else if (line.find("  Password: ") == 0) {
-                managers[managerCount].password = line.substr(12);
-            } else if (line.find("  Status: ") == 0) {
-                managers[managerCount].active = (line.substr(10) == "Active");
-                managerCount++; // Manager complete once status is read
-            }
+    string line;
+    string batch;
+    int batches = 0;
+    while (getline(journal, line)) {
+        if (line == "=== COMMIT ===") {
+            applyJournalBatch(batch);
+            batch.clear();
+            batches++;
+        } else {
+            batch += line + "\n";
         }
-        else if (currentSection == "cases" && caseCount < MAX_CASES) {
-            if (line.find("Case ID: ") == 0) {
-                try {
-                    cases[caseCount].id = stoi(line.substr(9));
-                    // Ensure nextCaseId stays ahead of highest ID found
-                    if (cases[caseCount].id >= nextCaseId) {
-                        nextCaseId = cases[caseCount].id + 1;
-                    }
-                } catch (...) {
-                    cerr << "Error parsing case ID" << endl;
-                    continue;
-                }
-            } else if (line.find("  Title: ") == 0) {
-                cases[caseCount].title = line.substr(9);
-            } else if (line.find("  Description: ") == 0) {
-                cases[caseCount].description = line.substr(15);
-            } else if (line.find("  Created: ") == 0) {
-                size_t atPos = line.find(" at ");
-                if (atPos != string::npos) {
-                    cases[caseCount].creationDate = line.substr(11, atPos - 11);
-                    cases[caseCount].creationTime = line.substr(atPos + 4);
+    }
+    if (batches > 0) {
+        cout << "Recovered " << batches << " autosaved changes from " << JOURNAL_FILE << "." << endl;
+    }
+}
+
+void applyJournalBatch(const string& batch) {
+    istringstream in(batch);
+    string line;
+    bool bodyUnchanged = false;
+
+    while (getline(in, line)) {
+        if (line == "Body Unchanged") {
+            bodyUnchanged = true;
+        } else if (line == "Manager:") {
+            Manager m;
+            while (getline(in, line)) {
+                if (line.find("  Name: ") == 0) {
+                    m.name = line.substr(8);
+                } else if (line.find("  Department: ") == 0) {
+                    m.department = line.substr(14);
+                } else if (line.find("  Password: ") == 0) {
+                    m.password = line.substr(12);
+                } else if (line.find("  Modified: ") == 0) {
+                    parseModifiedLine(line, m.modifiedSeq, m.modifiedDate, m.modifiedTime);
+                } else if (line.find("  Status: ") == 0) {
+                    m.active = (line.substr(10) == "Active");
+                    break;
                 }
-            } else if (line.find("  Source: ") == 0) {
-                cases[caseCount].source = line.substr(10);
-            } else if (line.find("  Status: ") == 0) {
-                cases[caseCount].status = line.substr(10);
-            } else if (line.find("  Assigned Managers (") == 0) {
-                cases[caseCount].assignedManagerCount = 0; // Reset count before reading managers
-            } else if (line.find("    - ") == 0 && cases[caseCount].assignedManagerCount < MAX_ASSIGNED_MANAGERS) {
-                cases[caseCount].assignedManagers[cases[caseCount].assignedManagerCount++] = line.substr(6);
-            } else if (line.find("  Actions (") == 0) {
-                cases[caseCount].actionCount = 0; // Reset count before reading actions
-            } else if (line.find("    - ") == 0 && cases[caseCount].actionCount < MAX_ACTIONS) {
-                Action& a = cases[caseCount].actions[cases[caseCount].actionCount];
-                size_t byPos = line.find(" by ");
-                size_t colonPos = line.find(": ", byPos);
-                if (byPos != string::npos && colonPos != string::npos) {
-                    string dateTime = line.substr(6, byPos - 6);
-                    size_t spacePos = dateTime.find(' ');
-                    if (spacePos != string::npos) {
-                        a.date = dateTime.substr(0, spacePos);
-                        a.time = dateTime.substr(spacePos + 1);
-                        a.manager = line.substr(byPos + 4, colonPos - (byPos + 4));
-                        a.description = line.substr(colonPos + 2);
-                        cases[caseCount].actionCount++;
+            }
+            m.dirty = true;
+            int index = findManagerIndex(m.name);
+            if (index != -1) {
+                managers[index] = m;
+            } else if (!managers.full()) {
+                managers.append(m);
+            }
+        } else if (line.find("Deleted Manager: ") == 0) {
+            int index = findManagerIndex(line.substr(17));
+            if (index == -1) continue;
+            managers.erase(index);
+        } else if (line.find("Case ID: ") == 0) {
+            Case record;
+            try {
+                record.id = stoi(line.substr(9));
+            } catch (...) {
+                continue;
+            }
+            CaseListMode listMode = LIST_NONE;
+            streampos next = in.tellg();
+            while (getline(in, line) && line.find("  ") == 0) {
+                parseCaseLine(record, line, listMode, true);
+                next = in.tellg();
+            }
+            in.clear();
+            in.seekg(next);
+
+            int index = findCaseIndex(record.id);
+            if (bodyUnchanged) {
+                if (index != -1) {
+                    Case& c = cases[index];
+                    c.title = record.title;
+                    c.creationDate = record.creationDate;
+                    c.creationTime = record.creationTime;
+                    c.source = record.source;
+                    c.status = record.status;
+                    c.modifiedSeq = record.modifiedSeq;
+                    c.modifiedDate = record.modifiedDate;
+                    c.modifiedTime = record.modifiedTime;
+                    c.assignedManagerCount = record.assignedManagerCount;
+                    for (int i = 0; i < record.assignedManagerCount; i++) {
+                        c.assignedManagers[i] = record.assignedManagers[i];
                     }
+                    c.dirty = true;
                 }
-            } else if (line.empty()) {
-                caseCount++; // Move to next case when a blank line is found
+                bodyUnchanged = false;
+                continue;
             }
-        }
-        else if (currentSection == "system") {
-            if (line.find("Next Case ID: ") == 0) {
-                try {
-                    nextCaseId = stoi(line.substr(14));
-                } catch (...) {
-                    cerr << "Error parsing next case ID" << endl;
-                }
+            record.bodyLoaded = true;
+            record.bodyModified = true;
+            record.recordOffset = -1;
+            record.dirty = true;
+            if (index != -1) {
+                cases[index] = record;
+            } else if (!cases.full()) {
+                cases.append(record);
+            }
+            if (record.id >= nextCaseId) nextCaseId = record.id + 1;
+        } else if (line.find("Deleted Case: ") == 0) {
+            int index = -1;
+            try {
+                index = findCaseIndex(stoi(line.substr(14)));
+            } catch (...) {
+                continue;
+            }
+            if (index == -1) continue;
+            cases.erase(index);
+        } else if (line.find("Tombstone ") == 0) {
+            parseTombstone(line);
+        } else if (line.find("Next Case ID: ") == 0) {
+            try {
+                int id = stoi(line.substr(14));
+                if (id > nextCaseId) nextCaseId = id;
+            } catch (...) {
+                cerr << "Error parsing next case ID" << endl;
             }
         }
     }
-
-    inFile.close();
-    cout << "Data loaded successfully from readable format. " 
-         << caseCount << " cases and " << managerCount << " managers found." << endl;
 }
 
 int findCaseIndex(int caseId) {
-    for (int i = 0; i < caseCount; i++) {
-        if (cases[i].id == caseId) {
-            return i;
-        }
-    }
-    return -1;
+    return cases.find(caseId);
 }
 
 int findManagerIndex(const string& managerName) {
-    for (int i = 0; i < managerCount; i++) {
-        if (managers[i].name == managerName) {
-            return i;
-        }
-    }
-    return -1;
+    return managers.find(managerName);
 }
 
 void printCaseHeader() {
@@ -1165,7 +7898,7 @@ void printCaseHeader() {
 
 void printCaseSummary(const Case& c) {
     cout << c.id << "\t" 
-         << (c.title.length() > 10 ? c.title.substr(0, 7) + "..." : c.title) << "\t"
+         << (c.title.length() > 10 ? c.title.str().substr(0, 7) + "..." : c.title.str()) << "\t"
          << c.status << "\t"
          << c.creationDate << endl;
 }